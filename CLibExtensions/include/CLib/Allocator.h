@@ -0,0 +1,60 @@
+/**
+ * @file Allocator.h
+ */
+
+#pragma once
+
+#include "CLibraryHeaders.h"
+#include <stddef.h>
+
+// A set of functions that a container gets its memory from, in place of calling malloc, realloc and free directly.
+// Every function is passed the context pointer, which holds whatever the allocator needs, such as the arena it hands
+// out memory from. Containers always pass the size that a piece of memory was allocated with, so allocators don't
+// have to keep track of sizes themselves.
+typedef struct tagAllocator
+{
+	// Allocates size bytes. Returns null on failure.
+	void* (*allocate)(size_t size, void* context);
+	// Resizes memory of oldSize bytes to newSize bytes, keeping its contents up to the smaller size. Allocates if
+	// memory is null. Returns null on failure, leaving the memory as it was.
+	void* (*reallocate)(void* memory, size_t oldSize, size_t newSize, void* context);
+	// Releases memory of size bytes. Does nothing if memory is null.
+	void (*release)(void* memory, size_t size, void* context);
+	// The state the functions work with.
+	void* context;
+} Allocator;
+
+// Gets the allocator that containers use when they aren't given one, which calls malloc, realloc and free.
+CLIBRARY_API const Allocator* AllocatorDefault(void);
+
+// Allocates size bytes from an allocator.
+CLIBRARY_API void* AllocatorAllocate(size_t size, const Allocator* allocator);
+
+// Allocates size bytes from an allocator, and sets them all to zero.
+CLIBRARY_API void* AllocatorAllocateZeroed(size_t size, const Allocator* allocator);
+
+// Resizes memory that was allocated from an allocator.
+CLIBRARY_API void* AllocatorReallocate(void* memory, size_t oldSize, size_t newSize, const Allocator* allocator);
+
+// Releases memory that was allocated from an allocator.
+CLIBRARY_API void AllocatorRelease(void* memory, size_t size, const Allocator* allocator);
+
+// Represents an arena: an allocator that hands out memory from large blocks, one piece after another, and frees it
+// all at once when the arena is reset or destroyed. Released pieces of up to 256 bytes, such as list nodes, are kept
+// and handed out again for allocations of the same size; bigger ones stay used until the arena is reset. An arena
+// suits containers that live and die together, such as everything one simulation uses. An arena is not safe to use
+// from several threads at once.
+typedef struct tagArena Arena;
+
+// Creates a new arena that allocates blocks of blockSize bytes at a time, or bigger ones for pieces of memory that
+// don't fit in one. Specify 0 to use the default block size of 64 KB.
+CLIBRARY_API bool ArenaCreate(size_t blockSize, Arena** arena);
+
+// Destroys an arena, freeing all the memory that was allocated from it.
+CLIBRARY_API void ArenaDestroy(Arena** arena);
+
+// Frees all the memory that was allocated from an arena at once, keeping its newest block to allocate from again.
+CLIBRARY_API void ArenaReset(Arena* arena);
+
+// Gets an allocator that allocates from an arena. It is valid for as long as the arena is.
+CLIBRARY_API void ArenaGetAllocator(Arena* arena, Allocator* allocator);
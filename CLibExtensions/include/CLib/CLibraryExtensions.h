@@ -26,6 +26,26 @@ typedef bool EqualsFunction(const void* obj1, const void* obj2);
 // equal, one is less than the other, or one is greater than the other.
 typedef int CompareToFunction(const void* obj1, const void* obj2);
 
+// A Sort Key Function type that extracts an unsigned integer key from an object, such as a timestamp,
+// which a radix sort can order objects by without comparing them to each other.
+typedef unsigned long long SortKeyFunction(const void* obj);
+
+// A Predicate Function type that tests an object for some condition, such as whether an item should be
+// removed from a container. The context is whatever the caller passed along with the predicate.
+typedef bool PredicateFunction(const void* obj, void* context);
+
+// A For Each Function type that is called on every object of a container, and may change it in place. The context is
+// whatever the caller passed along with the function.
+typedef void ForEachFunction(void* obj, void* context);
+
+// A Map Function type that computes a result from an object, such as a statistic about it, and writes the result
+// into result. The context is whatever the caller passed along with the function.
+typedef void MapFunction(const void* obj, void* result, void* context);
+
+// A Reduce Function type that folds a value into an accumulator, such as by adding it to a running total. The
+// context is whatever the caller passed along with the function.
+typedef void ReduceFunction(void* accumulator, const void* value, void* context);
+
 // An implementation for the Equals function that compares two characters to each other.
 CLIBRARY_API bool CharacterEquals(const void* obj1, const void* obj2);
 
@@ -41,7 +61,13 @@ CLIBRARY_API int StringHashCode(const void* keyObj);
 // A hash code implementation for integers.
 CLIBRARY_API int IntegerHashCode(const void* keyObj);
 
+#include "Allocator.h"
 #include "Stack.h"
 #include "Vector.h"
 #include "LinkedList.h"
-#include "HashTable.h"
\ No newline at end of file
+#include "HashTable.h"
+#include "TimingWheel.h"
+#include "ThreadPool.h"
+#include "TypedVector.h"
+#include "TypedStack.h"
+#include "SmallVector.h"
\ No newline at end of file
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "CLibraryExtensions.h"
+#include "Allocator.h"
 
 // Represents a Data Structure that allows for fast, O(1) search time to get items.
 typedef struct tagHashTable HashTable;
@@ -30,6 +31,9 @@ typedef struct tagHashTableInitData
 	// A HashCode function that returns a number uniquely identifying an instance of something. Used to pick
 	// the bucket that a value goes into based on the key. This is required.
 	HashCodeFunction* hashCodeImpl;
+	// The allocator that the table, its buckets and its items get their memory from. Specify null to use the
+	// default allocator, which uses malloc.
+	const Allocator* allocator;
 
 } HashTableInitData;
 
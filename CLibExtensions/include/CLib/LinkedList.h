@@ -6,6 +6,7 @@
 #pragma once
 
 #include "CLibraryHeaders.h"
+#include "Allocator.h"
 
 // Represents a Linked List of items. This can also act as a queue of objects or stack of objects.
 typedef struct tagLinkedList LinkedList;
@@ -13,6 +14,10 @@ typedef struct tagLinkedList LinkedList;
 // Creates a new LinkedList object.
 CLIBRARY_API bool LinkedListCreate(int dataTypeSize, LinkedList** list);
 
+// Creates a new LinkedList object that gets all of its memory, including every node, from the given allocator. A null
+// allocator means the default one, which uses malloc.
+CLIBRARY_API bool LinkedListCreateWithAllocator(int dataTypeSize, const Allocator* allocator, LinkedList** list);
+
 // Destroys a LinkedList of items.
 CLIBRARY_API void LinkedListDestroy(LinkedList** list);
 
@@ -26,14 +31,15 @@ CLIBRARY_API bool LinkedListInsert(const void* value, int index, LinkedList* lis
 CLIBRARY_API bool LinkedListPop(LinkedList* list);
 
 // Removes the item at the end of the linked list, without freeing the memory. Instead,
-// the value is returned. NULL is returned on failure.
+// the value is returned. NULL is returned on failure. The value comes from the list's allocator, and
+// is dataTypeSize bytes long, which is what releasing it takes; with the default allocator, use free.
 CLIBRARY_API void* LinkedListPopSafe(LinkedList* list);
 
 // Removes the item at the specified index of a linked list.
 CLIBRARY_API bool LinkedListRemove(int index, LinkedList* list);
 
 // Removes the item at the specified index of a linked list, without freeing the memory. Instead,
-// the value is returned.
+// the value is returned. As with LinkedListPopSafe, the value comes from the list's allocator.
 CLIBRARY_API void* LinkedListRemoveSafe(int index, LinkedList* list);
 
 // Removes all items from the LinkedList, leaving it in an empty state.
@@ -0,0 +1,129 @@
+/**
+ * @file SmallVector.h
+ */
+
+#pragma once
+
+#include "CLibraryHeaders.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Defines a vector that holds items of one type, T, named TSmallVector, with room for its first N items inside the
+// structure itself. Declared as a local variable or a field, a small vector that never holds more than N items makes
+// no allocations at all; only when it grows past N are its items moved to the heap. Like the typed vector from
+// CLIB_DEFINE_VECTOR, its structure is not hidden and its functions are static inline. Use
+// CLIB_DEFINE_SMALL_VECTOR_NAMED for types whose names cannot be pasted onto, such as pointers.
+//
+// The items are found through Data rather than a pointer kept in the structure, so a small vector can be copied or
+// moved like any other structure:
+//
+//     CLIB_DEFINE_SMALL_VECTOR(int, 8)
+//     intSmallVector values;
+//     intSmallVectorCreate(&values);
+//     int value = 3;
+//     intSmallVectorPush(&value, &values);
+//     int* items = intSmallVectorData(&values);
+//     intSmallVectorDestroy(&values);
+#define CLIB_DEFINE_SMALL_VECTOR(T, N) CLIB_DEFINE_SMALL_VECTOR_NAMED(T, N, T##SmallVector)
+
+#define CLIB_DEFINE_SMALL_VECTOR_NAMED(T, N, Name)                                                                  \
+    typedef struct tag##Name                                                                                        \
+    {                                                                                                               \
+        /* The items once they have moved to the heap, or NULL while they are still inline. */                      \
+        T* heapItems;                                                                                               \
+        /* The number of items stored in the vector. */                                                             \
+        unsigned int numItems;                                                                                      \
+        /* The number of items there is room for before the vector has to grow. */                                  \
+        unsigned int currentCapacity;                                                                               \
+        /* The room for the first N items. */                                                                       \
+        T inlineItems[N];                                                                                           \
+    } Name;                                                                                                         \
+                                                                                                                    \
+    /* Creates a new, empty vector, with room for N items without allocating. */                                    \
+    static inline void Name##Create(Name* vect)                                                                     \
+    {                                                                                                               \
+        vect->heapItems = NULL;                                                                                     \
+        vect->numItems = 0;                                                                                         \
+        vect->currentCapacity = N;                                                                                  \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Destroys a vector, freeing its items if they moved to the heap. */                                           \
+    static inline void Name##Destroy(Name* vect)                                                                    \
+    {                                                                                                               \
+        free(vect->heapItems);                                                                                      \
+        Name##Create(vect);                                                                                         \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Gets the items of the vector, wherever they are stored. The pointer changes when the vector grows. */        \
+    static inline T* Name##Data(Name* vect)                                                                         \
+    {                                                                                                               \
+        return vect->heapItems != NULL ? vect->heapItems : vect->inlineItems;                                       \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Returns true if the items are still stored inside the vector, otherwise returns false. */                    \
+    static inline bool Name##IsInline(const Name* vect)                                                             \
+    {                                                                                                               \
+        return vect->heapItems == NULL;                                                                             \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Makes room for at least capacity items, moving the items to the heap if they no longer fit inline. */        \
+    static inline bool Name##Reserve(unsigned int capacity, Name* vect)                                             \
+    {                                                                                                               \
+        if (capacity <= vect->currentCapacity)                                                                      \
+            return true;                                                                                            \
+        T* items = (T*)realloc(vect->heapItems, capacity * sizeof(T));                                              \
+        if (items == NULL)                                                                                          \
+            return false;                                                                                           \
+        if (vect->heapItems == NULL)                                                                                \
+            memcpy(items, vect->inlineItems, vect->numItems * sizeof(T));                                           \
+        vect->heapItems = items;                                                                                    \
+        vect->currentCapacity = capacity;                                                                           \
+        return true;                                                                                                \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Adds a copy of an item to the end of the vector. The vector doubles in size when it runs out of room. */     \
+    static inline bool Name##Push(const T* item, Name* vect)                                                        \
+    {                                                                                                               \
+        if (vect->numItems == vect->currentCapacity && !Name##Reserve(vect->currentCapacity * 2, vect))             \
+            return false;                                                                                           \
+        Name##Data(vect)[vect->numItems++] = *item;                                                                 \
+        return true;                                                                                                \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Removes the last item from the vector, copying it into item first if item is not NULL. Returns false if      \
+       the vector is empty. */                                                                                      \
+    static inline bool Name##Pop(T* item, Name* vect)                                                               \
+    {                                                                                                               \
+        if (vect->numItems == 0)                                                                                    \
+            return false;                                                                                           \
+        vect->numItems--;                                                                                           \
+        if (item != NULL)                                                                                           \
+            *item = Name##Data(vect)[vect->numItems];                                                               \
+        return true;                                                                                                \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Gets the item at the specified index, or NULL if the index is out of bounds. */                              \
+    static inline T* Name##Get(int index, Name* vect)                                                               \
+    {                                                                                                               \
+        if (index < 0 || (unsigned int)index >= vect->numItems)                                                     \
+            return NULL;                                                                                            \
+        return &Name##Data(vect)[index];                                                                            \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Gets the number of items stored in the vector. */                                                            \
+    static inline unsigned int Name##Count(const Name* vect)                                                        \
+    {                                                                                                               \
+        return vect->numItems;                                                                                      \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Returns true if the vector is empty, otherwise returns false. */                                             \
+    static inline bool Name##IsEmpty(const Name* vect)                                                              \
+    {                                                                                                               \
+        return vect->numItems == 0;                                                                                 \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Removes all items from the vector, keeping its capacity. */                                                  \
+    static inline void Name##Clear(Name* vect)                                                                      \
+    {                                                                                                               \
+        vect->numItems = 0;                                                                                         \
+    }
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "CLibraryHeaders.h"
+#include "Allocator.h"
 
 // Represents a LIFO Stack object.
 typedef struct tagStack Stack;
@@ -13,6 +14,11 @@ typedef struct tagStack Stack;
 // Creates a new stack object.
 CLIBRARY_API bool StackCreate(int dataTypeSize, int initialCapacity, int maxStackSize, Stack** stackObj);
 
+// Creates a new stack object that gets all of its memory from the given allocator. A null allocator means the default
+// one, which uses malloc.
+CLIBRARY_API bool StackCreateWithAllocator(int dataTypeSize, int initialCapacity, int maxStackSize,
+    const Allocator* allocator, Stack** stackObj);
+
 // Destroys a stack object.
 CLIBRARY_API void StackDestroy(Stack** stackObj);
 
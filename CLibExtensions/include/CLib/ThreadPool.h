@@ -0,0 +1,36 @@
+/**
+ * @file ThreadPool.h
+ */
+
+#pragma once
+
+#include "CLibraryHeaders.h"
+
+// Represents a pool of worker threads that are started once and reused for every job given to the pool. A job covers
+// a range of indices, which is split into chunks that the workers, and the thread that gave the job, take one at a time
+// until none are left, so a chunk that runs slowly doesn't hold up the others. Uses POSIX threads.
+typedef struct tagThreadPool ThreadPool;
+
+// A function that does one chunk of a job, on the indices from start up to but not including end. The chunk number
+// counts up from 0 in index order, which lets a job keep a result for every chunk.
+typedef void ThreadPoolJobFunction(unsigned int chunk, unsigned int start, unsigned int end, void* context);
+
+// Creates a new thread pool, where threadCount threads work on every job, counting the thread that gives the job.
+// Specify 0 to use one thread per processor.
+CLIBRARY_API bool ThreadPoolCreate(unsigned int threadCount, ThreadPool** pool);
+
+// Destroys a thread pool, waiting for its workers to stop.
+CLIBRARY_API void ThreadPoolDestroy(ThreadPool** pool);
+
+// Gets the number of threads that work on every job, counting the thread that gives the job. A null pool has 1.
+CLIBRARY_API unsigned int ThreadPoolCountThreads(ThreadPool* pool);
+
+// Gets the number of chunks ThreadPoolRun splits count indices into, where each chunk has at least minChunkSize of them
+// unless there are fewer in all. There are enough chunks to keep every thread busy, and none if count is 0.
+CLIBRARY_API unsigned int ThreadPoolCountChunks(unsigned int count, unsigned int minChunkSize, ThreadPool* pool);
+
+// Runs a job over the indices from 0 up to but not including count, split into ThreadPoolCountChunks chunks, and
+// returns once every chunk is done. The calling thread works on the job too, and does all of it if the pool is null or
+// there is only one chunk. Jobs given to one pool from several threads run one after another.
+CLIBRARY_API void ThreadPoolRun(unsigned int count, unsigned int minChunkSize, ThreadPoolJobFunction* job,
+    void* context, ThreadPool* pool);
@@ -0,0 +1,61 @@
+/**
+ * @file TimingWheel.h
+ */
+
+#pragma once
+
+#include "CLibraryHeaders.h"
+#include "Allocator.h"
+
+// Represents a hierarchical timing wheel: a queue of timers keyed by an unsigned integer expiry time. Scheduling and
+// cancelling a timer are O(1), and advancing the wheel is amortized O(1) per timer, no matter how many timers are
+// pending. Timers that expire on the same tick come out in the order they were scheduled.
+typedef struct tagTimingWheel TimingWheel;
+
+// Identifies a timer that was scheduled on a TimingWheel. A handle stays valid until its timer is popped or
+// cancelled, after which the wheel may reuse it for a new timer.
+typedef int TimerHandle;
+
+// Creates a new timing wheel whose clock starts at startTime. Each timer carries a copy of dataTypeSize bytes.
+CLIBRARY_API bool TimingWheelCreate(unsigned int dataTypeSize, unsigned int startTime, TimingWheel** wheel);
+
+// Creates a new timing wheel that gets all of its memory from the given allocator. A null allocator means the default
+// one, which uses malloc.
+CLIBRARY_API bool TimingWheelCreateWithAllocator(unsigned int dataTypeSize, unsigned int startTime,
+    const Allocator* allocator, TimingWheel** wheel);
+
+// Destroys a timing wheel, along with any timers still in it.
+CLIBRARY_API void TimingWheelDestroy(TimingWheel** wheel);
+
+// Schedules a timer that expires at expiryTime, copying data into the timer. A timer whose expiry time is not
+// after the wheel's current time is expired immediately. If handle is not NULL, it receives a handle that can be
+// used to cancel the timer.
+CLIBRARY_API bool TimingWheelSchedule(const void* data, unsigned int expiryTime, TimerHandle* handle,
+    TimingWheel* wheel);
+
+// Cancels a timer that has not been popped yet. Returns false if the handle does not refer to a live timer.
+CLIBRARY_API bool TimingWheelCancel(TimerHandle handle, TimingWheel* wheel);
+
+// Moves the wheel's clock forward to the given time, expiring every timer whose expiry time is at or before it.
+// Stretches of time with no timers in them are skipped over rather than walked tick by tick.
+CLIBRARY_API void TimingWheelAdvance(unsigned int time, TimingWheel* wheel);
+
+// Removes the next expired timer, copying its data into data and its expiry time into expiryTime (either may be
+// NULL). Returns false if no timer has expired.
+CLIBRARY_API bool TimingWheelPopExpired(void* data, unsigned int* expiryTime, TimingWheel* wheel);
+
+// Gets the earliest expiry time of any timer still waiting in the wheel. Returns false if no timer is waiting.
+// Timers that have already expired but were not popped yet are not considered.
+CLIBRARY_API bool TimingWheelNextExpiry(unsigned int* expiryTime, TimingWheel* wheel);
+
+// Gets the current time of the wheel's clock.
+CLIBRARY_API unsigned int TimingWheelCurrentTime(TimingWheel* wheel);
+
+// Gets the number of timers in the wheel, counting expired timers that were not popped yet.
+CLIBRARY_API int TimingWheelCount(TimingWheel* wheel);
+
+// Returns true if the wheel contains no timers, otherwise false.
+CLIBRARY_API bool TimingWheelIsEmpty(TimingWheel* wheel);
+
+// Removes every timer from the wheel. The wheel's clock is left where it is.
+CLIBRARY_API void TimingWheelClear(TimingWheel* wheel);
@@ -0,0 +1,85 @@
+/**
+ * @file TypedStack.h
+ */
+
+#pragma once
+
+#include "TypedVector.h"
+
+// Defines a LIFO stack that holds items of one type, T, named TStack. Like the generic Stack, it is a vector with some
+// extra methods, here the typed vector from CLIB_DEFINE_VECTOR, so pushing, popping and peeking are inline and copy
+// items by assignment. Use CLIB_DEFINE_STACK_NAMED for types whose names cannot be pasted onto, such as pointers.
+//
+//     CLIB_DEFINE_STACK(int)
+//     intStack stack;
+//     intStackCreate(16, &stack);
+//     int value = 3;
+//     intStackPush(&value, &stack);
+//     intStackPop(&value, &stack);
+//     intStackDestroy(&stack);
+#define CLIB_DEFINE_STACK(T) CLIB_DEFINE_STACK_NAMED(T, T##Stack)
+
+#define CLIB_DEFINE_STACK_NAMED(T, Name)                                                                            \
+    CLIB_DEFINE_VECTOR_NAMED(T, Name##Items)                                                                        \
+                                                                                                                    \
+    typedef struct tag##Name                                                                                        \
+    {                                                                                                               \
+        /* The vector that stores all the items, with the top of the stack at the end. */                           \
+        Name##Items items;                                                                                          \
+    } Name;                                                                                                         \
+                                                                                                                    \
+    /* Creates a new stack, with room for initialCapacity items. */                                                 \
+    static inline bool Name##Create(unsigned int initialCapacity, Name* stack)                                     \
+    {                                                                                                               \
+        return Name##Items##Create(initialCapacity, &stack->items);                                                 \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Destroys a stack, freeing its items. */                                                                      \
+    static inline void Name##Destroy(Name* stack)                                                                   \
+    {                                                                                                               \
+        Name##Items##Destroy(&stack->items);                                                                        \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Adds a copy of an item to the top of the stack. */                                                           \
+    static inline bool Name##Push(const T* item, Name* stack)                                                      \
+    {                                                                                                               \
+        return Name##Items##Push(item, &stack->items);                                                              \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Pops off the item on the top of the stack, copying it into item first if item is not NULL. Returns false   \
+       if the stack is empty. */                                                                                    \
+    static inline bool Name##Pop(T* item, Name* stack)                                                             \
+    {                                                                                                               \
+        return Name##Items##Pop(item, &stack->items);                                                               \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Gets the item at the top of the stack, or NULL if the stack is empty. */                                     \
+    static inline T* Name##Peek(Name* stack)                                                                        \
+    {                                                                                                               \
+        return Name##Items##Get((int)stack->items.numItems - 1, &stack->items);                                     \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Gets the item at the specified index of the stack, counting from the bottom, or NULL if the index is out of \
+       bounds. */                                                                                                   \
+    static inline T* Name##Get(int index, Name* stack)                                                             \
+    {                                                                                                               \
+        return Name##Items##Get(index, &stack->items);                                                              \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Counts the number of items currently in the stack. */                                                        \
+    static inline unsigned int Name##Count(const Name* stack)                                                       \
+    {                                                                                                               \
+        return stack->items.numItems;                                                                               \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Returns a value indicating whether or not the stack is empty. */                                             \
+    static inline bool Name##IsEmpty(const Name* stack)                                                             \
+    {                                                                                                               \
+        return stack->items.numItems == 0;                                                                          \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Clears out all the items of a stack, keeping its capacity. */                                                \
+    static inline void Name##Clear(Name* stack)                                                                     \
+    {                                                                                                               \
+        stack->items.numItems = 0;                                                                                  \
+    }
@@ -0,0 +1,112 @@
+/**
+ * @file TypedVector.h
+ */
+
+#pragma once
+
+#include "CLibraryHeaders.h"
+#include <stdlib.h>
+
+// Defines a vector that holds items of one type, T, named TVector. Unlike the generic Vector, its structure is not
+// hidden and its functions are static inline, so the compiler knows the size of the items: getting an item is plain
+// pointer arithmetic, and adding one is a plain assignment rather than a call that multiplies and copies bytes. Use
+// CLIB_DEFINE_VECTOR_NAMED for types whose names cannot be pasted onto, such as pointers.
+//
+// The vector lives wherever the caller declares it, so create and destroy take a pointer to it:
+//
+//     CLIB_DEFINE_VECTOR(InputProcess)
+//     InputProcessVector queue;
+//     InputProcessVectorCreate(16, &queue);
+//     InputProcessVectorPush(&process, &queue);
+//     InputProcess* first = InputProcessVectorGet(0, &queue);
+//     InputProcessVectorDestroy(&queue);
+#define CLIB_DEFINE_VECTOR(T) CLIB_DEFINE_VECTOR_NAMED(T, T##Vector)
+
+#define CLIB_DEFINE_VECTOR_NAMED(T, Name)                                                                           \
+    typedef struct tag##Name                                                                                        \
+    {                                                                                                               \
+        /* The items, of which the first numItems are in use. */                                                    \
+        T* data;                                                                                                    \
+        /* The number of items stored in the vector. */                                                             \
+        unsigned int numItems;                                                                                      \
+        /* The number of items there is room for before the vector has to grow. */                                 \
+        unsigned int currentCapacity;                                                                               \
+    } Name;                                                                                                         \
+                                                                                                                    \
+    /* Creates a new vector, with room for initialCapacity items. */                                                \
+    static inline bool Name##Create(unsigned int initialCapacity, Name* vect)                                      \
+    {                                                                                                               \
+        vect->numItems = 0;                                                                                         \
+        vect->currentCapacity = initialCapacity;                                                                    \
+        vect->data = initialCapacity > 0 ? (T*)malloc(initialCapacity * sizeof(T)) : NULL;                          \
+        return initialCapacity == 0 || vect->data != NULL;                                                          \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Destroys a vector, freeing its items. */                                                                     \
+    static inline void Name##Destroy(Name* vect)                                                                    \
+    {                                                                                                               \
+        free(vect->data);                                                                                           \
+        vect->data = NULL;                                                                                          \
+        vect->numItems = vect->currentCapacity = 0;                                                                 \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Makes room for at least capacity items. */                                                                   \
+    static inline bool Name##Reserve(unsigned int capacity, Name* vect)                                            \
+    {                                                                                                               \
+        if (capacity <= vect->currentCapacity)                                                                      \
+            return true;                                                                                            \
+        T* data = (T*)realloc(vect->data, capacity * sizeof(T));                                                    \
+        if (data == NULL)                                                                                           \
+            return false;                                                                                           \
+        vect->data = data;                                                                                          \
+        vect->currentCapacity = capacity;                                                                           \
+        return true;                                                                                                \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Adds a copy of an item to the end of the vector. The vector doubles in size when it runs out of room. */     \
+    static inline bool Name##Push(const T* item, Name* vect)                                                       \
+    {                                                                                                               \
+        if (vect->numItems == vect->currentCapacity &&                                                              \
+            !Name##Reserve(vect->currentCapacity > 0 ? vect->currentCapacity * 2 : 4, vect))                        \
+            return false;                                                                                           \
+        vect->data[vect->numItems++] = *item;                                                                       \
+        return true;                                                                                                \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Removes the last item from the vector, copying it into item first if item is not NULL. Returns false if    \
+       the vector is empty. */                                                                                      \
+    static inline bool Name##Pop(T* item, Name* vect)                                                              \
+    {                                                                                                               \
+        if (vect->numItems == 0)                                                                                    \
+            return false;                                                                                           \
+        vect->numItems--;                                                                                           \
+        if (item != NULL)                                                                                           \
+            *item = vect->data[vect->numItems];                                                                     \
+        return true;                                                                                                \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Gets the item at the specified index, or NULL if the index is out of bounds. */                             \
+    static inline T* Name##Get(int index, Name* vect)                                                              \
+    {                                                                                                               \
+        if (index < 0 || (unsigned int)index >= vect->numItems)                                                     \
+            return NULL;                                                                                            \
+        return &vect->data[index];                                                                                  \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Gets the number of items stored in the vector. */                                                            \
+    static inline unsigned int Name##Count(const Name* vect)                                                        \
+    {                                                                                                               \
+        return vect->numItems;                                                                                      \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Returns true if the vector is empty, otherwise returns false. */                                             \
+    static inline bool Name##IsEmpty(const Name* vect)                                                              \
+    {                                                                                                               \
+        return vect->numItems == 0;                                                                                 \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Removes all items from the vector, keeping its capacity. */                                                  \
+    static inline void Name##Clear(Name* vect)                                                                      \
+    {                                                                                                               \
+        vect->numItems = 0;                                                                                         \
+    }
@@ -6,7 +6,9 @@
 #pragma once
 
 #include "CLibraryHeaders.h"
+#include "Allocator.h"
 #include "CLibraryExtensions.h"
+#include "ThreadPool.h"
 
 // Represents an array that is resized automatically as items are added to it.
 typedef struct tagVector Vector;
@@ -15,15 +17,61 @@ typedef struct tagVector Vector;
 CLIBRARY_API bool VectorCreate(unsigned int dataTypeSize, unsigned int initialCapacity,
     unsigned int maxCapacity, EqualsFunction* equalsImpl, CompareToFunction* compareImpl, Vector** vect);
 
+// Creates a new vector object, allocating an initial size, that gets all of its memory from the given allocator. A null
+// allocator means the default one, which uses malloc.
+CLIBRARY_API bool VectorCreateWithAllocator(unsigned int dataTypeSize, unsigned int initialCapacity,
+    unsigned int maxCapacity, EqualsFunction* equalsImpl, CompareToFunction* compareImpl, const Allocator* allocator,
+    Vector** vect);
+
+// Creates a new vector object whose items are stored in a memory-mapped file, so that it can hold more than fits in
+// memory and the operating system pages the items in and out as they are used. Every other vector function works on
+// it as usual. If the file already exists, the vector starts out with the items stored in it. The file grows as the
+// vector does, and when the vector is destroyed the file is trimmed to exactly its items. Not supported on Windows.
+CLIBRARY_API bool VectorCreateMapped(const char* path, unsigned int dataTypeSize, unsigned int initialCapacity,
+    unsigned int maxCapacity, EqualsFunction* equalsImpl, CompareToFunction* compareImpl, Vector** vect);
+
 // Destroys a vector object.
 CLIBRARY_API void VectorDestroy(Vector** vect);
 
+// Writes the items of a mapped vector out to its file, returning once they are on disk. Does nothing for other
+// vectors.
+CLIBRARY_API bool VectorSync(Vector* vect);
+
+// Returns true if the vector's items are stored in a memory-mapped file, otherwise returns false.
+CLIBRARY_API bool VectorIsMapped(Vector* vect);
+
 // Adds an item to the end of the vector.
 CLIBRARY_API bool VectorAdd(const void* data, Vector* vect);
 
+// Adds an item to the end of the vector without copying anything into it, and returns a pointer to it so the caller can
+// fill it in where it lies. The item's contents are undefined until then. Returns null if the vector can't grow.
+// The pointer is only valid until the vector next grows.
+CLIBRARY_API void* VectorEmplaceBack(Vector* vect);
+
+// Makes sure the vector has room for at least the given number of items, so adding up to that many never reallocates.
+// Returns false if the room can't be allocated, or would exceed the vector's maximum capacity.
+CLIBRARY_API bool VectorReserve(unsigned int capacity, Vector* vect);
+
+// Frees any room in the vector beyond the items it holds.
+CLIBRARY_API bool VectorShrinkToFit(Vector* vect);
+
+// Changes the number of items in the vector. Items past the new count are dropped, and new items are zeroed.
+CLIBRARY_API bool VectorResize(unsigned int count, Vector* vect);
+
+// Sets how many times bigger the vector gets when an item is added to it while it is full. This has to be greater than
+// one; the default is three.
+CLIBRARY_API bool VectorSetGrowthFactor(float growthFactor, Vector* vect);
+
+// Adds count items, stored one after another at data, to the end of the vector. The vector grows at most once.
+CLIBRARY_API bool VectorAddRange(const void* data, unsigned int count, Vector* vect);
+
 // Inserts an item into the vector at the specified index.
 CLIBRARY_API bool VectorInsert(const void* data, int index, Vector* vect);
 
+// Inserts count items, stored one after another at data, into the vector at the specified index. The items after the
+// index are moved only once, however many are inserted.
+CLIBRARY_API bool VectorInsertRange(const void* data, unsigned int count, int index, Vector* vect);
+
 // Replaces the data at the specified index with the new data.
 CLIBRARY_API bool VectorReplace(const void* data, int index, Vector* vect);
 
@@ -38,6 +86,13 @@ CLIBRARY_API bool VectorRemove(int index, Vector* vect);
 // null if the operation fails.
 CLIBRARY_API void* VectorRemoveSafe(int index, Vector* vect);
 
+// Removes count items from the vector, starting at the specified index. The items after them are moved only once.
+CLIBRARY_API bool VectorRemoveRange(int index, unsigned int count, Vector* vect);
+
+// Removes every item that the predicate returns true for, keeping the order of the rest, in a single pass over the
+// vector. The context is passed to every call of the predicate. Returns the number of items removed.
+CLIBRARY_API unsigned int VectorRemoveIf(PredicateFunction* predicate, void* context, Vector* vect);
+
 // Gets the first index that a particular element is at. If the element is not found, returns -1. This requires
 // a pointer to an appropriate "Equals" method implementation to have been set.
 CLIBRARY_API int VectorIndexOf(const void* data, Vector* vect);
@@ -46,6 +101,25 @@ CLIBRARY_API int VectorIndexOf(const void* data, Vector* vect);
 // implementation to have been set.
 CLIBRARY_API bool VectorContains(const void* data, Vector* vect);
 
+// Finds the index of an item in a sorted vector with a binary search. If the element is not found, returns -1. If
+// several items compare equal to it, any one of them may be found. This requires a pointer to an appropriate
+// "CompareTo" method implementation to have been set, and the vector to be sorted by it.
+CLIBRARY_API int VectorBinarySearch(const void* data, Vector* vect);
+
+// Gets the index of the first item in a sorted vector that does not sort before the given item, which is the number
+// of items if they all do. This requires a pointer to an appropriate "CompareTo" method implementation to have been
+// set, and the vector to be sorted by it.
+CLIBRARY_API unsigned int VectorLowerBound(const void* data, Vector* vect);
+
+// Gets the index of the first item in a sorted vector that sorts after the given item, which is the number of items if
+// none do. This requires a pointer to an appropriate "CompareTo" method implementation to have been set, and the
+// vector to be sorted by it.
+CLIBRARY_API unsigned int VectorUpperBound(const void* data, Vector* vect);
+
+// Inserts an item into a sorted vector where it keeps the vector sorted, after any items equal to it. This requires a
+// pointer to an appropriate "CompareTo" method implementation to have been set, and the vector to be sorted by it.
+CLIBRARY_API bool VectorInsertSorted(const void* data, Vector* vect);
+
 // Gets the number of items that are currently stored in a vector.
 CLIBRARY_API unsigned int VectorCount(Vector* vect);
 
@@ -63,5 +137,36 @@ CLIBRARY_API void VectorClear(Vector* vect);
 CLIBRARY_API bool VectorCopy(Vector* vectOther, Vector* vect);
 
 // Sorts the items in a vector. This requires a pointer to an appropriate "CompareTo" method implementation
-// to have been set.
+// to have been set. Vectors that are already sorted, forwards or backwards, take a single pass; otherwise this is an
+// introsort, which is O(n log n) whatever the order of the items. The order of equal items is not kept.
 CLIBRARY_API void VectorSort(Vector* vect);
+
+// Sorts the items in a vector, keeping equal items in the order they were in. This requires a pointer to an
+// appropriate "CompareTo" method implementation to have been set. It is a merge sort, which needs a buffer as big as
+// the vector; returns false if the buffer can't be allocated, in which case the vector is unchanged.
+CLIBRARY_API bool VectorStableSort(Vector* vect);
+
+// Sorts the items in a vector by the unsigned keys that keyFunction extracts from them, keeping items with equal keys
+// in the order they were in. It is a radix sort, so it takes time proportional to the number of items rather than
+// calling a compare function O(n log n) times. Returns false if its buffers can't be allocated, in which case the
+// vector is unchanged.
+CLIBRARY_API bool VectorSortByKey(SortKeyFunction* keyFunction, Vector* vect);
+
+// Calls function on every item in a vector, splitting the items into chunks that run at the same time on the threads
+// of a pool. Calls for different items can run in any order, and at the same time, so function must be safe to call
+// from several threads as long as no two calls share an item. A null pool runs every call on the calling thread.
+CLIBRARY_API void VectorParallelForEach(ForEachFunction* function, void* context, ThreadPool* pool, Vector* vect);
+
+// Maps every item in a vector to an item of the destination vector, which is resized to hold one result per item, so
+// function writes the result for item i into item i of the destination. Runs in chunks on the threads of a pool, like
+// VectorParallelForEach. The destination must be a different vector; returns false if it can't be resized.
+CLIBRARY_API bool VectorParallelMap(MapFunction* function, void* context, Vector* destination, ThreadPool* pool,
+    Vector* vect);
+
+// Reduces all the items in a vector to a single result of resultSize bytes, on the threads of a pool. The result
+// starts out holding the identity value, such as 0 for a sum. Each chunk of items starts from its own copy of the
+// identity and folds in its items with accumulate, and the results of the chunks are then folded together in order
+// with combine, which must be associative. Without a pool, this is a plain loop of accumulate calls. Returns false
+// if the chunks' results can't be allocated, in which case the result is unchanged.
+CLIBRARY_API bool VectorParallelReduce(ReduceFunction* accumulate, ReduceFunction* combine, unsigned int resultSize,
+    void* result, void* context, ThreadPool* pool, Vector* vect);
@@ -0,0 +1,233 @@
+#include "CLib/Allocator.h"
+#include <stdlib.h>
+#include <string.h>
+
+// The size of the blocks an arena allocates, by default.
+#define DEFAULT_ARENA_BLOCK_SIZE (64 * 1024)
+
+// Every piece of memory an arena hands out is aligned to this many bytes, which suits any type.
+#define ARENA_ALIGNMENT 16
+
+// Released pieces of up to this many bytes are kept on a free list for their size, to be handed out again.
+#define ARENA_MAX_RECYCLED_SIZE 256
+#define ARENA_FREE_LIST_COUNT (ARENA_MAX_RECYCLED_SIZE / ARENA_ALIGNMENT)
+
+static void* DefaultAllocate(size_t size, void* context)
+{
+	(void)context;
+	return malloc(size);
+}
+
+static void* DefaultReallocate(void* memory, size_t oldSize, size_t newSize, void* context)
+{
+	(void)oldSize;
+	(void)context;
+	return realloc(memory, newSize);
+}
+
+static void DefaultRelease(void* memory, size_t size, void* context)
+{
+	(void)size;
+	(void)context;
+	free(memory);
+}
+
+// The allocator containers use when they aren't given one.
+static const Allocator DefaultAllocator = { DefaultAllocate, DefaultReallocate, DefaultRelease, NULL };
+
+const Allocator* AllocatorDefault(void)
+{
+	return &DefaultAllocator;
+}
+
+void* AllocatorAllocate(size_t size, const Allocator* allocator)
+{
+	return allocator->allocate(size, allocator->context);
+}
+
+void* AllocatorAllocateZeroed(size_t size, const Allocator* allocator)
+{
+	// The default allocator can get zeroed memory straight from calloc, which is often already zeroed by the system.
+	if (allocator->allocate == DefaultAllocate)
+		return calloc(1, size);
+
+	void* memory = allocator->allocate(size, allocator->context);
+	if (memory != NULL)
+		memset(memory, 0, size);
+	return memory;
+}
+
+void* AllocatorReallocate(void* memory, size_t oldSize, size_t newSize, const Allocator* allocator)
+{
+	return allocator->reallocate(memory, oldSize, newSize, allocator->context);
+}
+
+void AllocatorRelease(void* memory, size_t size, const Allocator* allocator)
+{
+	if (memory != NULL)
+		allocator->release(memory, size, allocator->context);
+}
+
+// A block of memory that an arena hands out pieces of. The pieces follow the header.
+typedef struct tagArenaBlock ArenaBlock;
+
+typedef struct tagArenaBlock
+{
+	// The block that was allocated before this one.
+	ArenaBlock* previous;
+	// The number of bytes after the header.
+	size_t size;
+	// The number of bytes after the header that have been handed out.
+	size_t used;
+} ArenaBlock;
+
+// The implementation of the arena object.
+typedef struct tagArena
+{
+	// The block that memory is currently handed out from, which links back to all the older blocks.
+	ArenaBlock* current;
+	// The size of new blocks.
+	size_t blockSize;
+	// The last piece of memory handed out from the current block, which can still be grown or given back in place.
+	char* lastAllocation;
+	// The released pieces of each small size, linked through their first bytes. Index i holds pieces of
+	// (i + 1) * ARENA_ALIGNMENT bytes.
+	void* freeLists[ARENA_FREE_LIST_COUNT];
+} Arena;
+
+// Rounds a size up to a multiple of the arena alignment.
+static size_t ArenaAlign(size_t size)
+{
+	return (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+}
+
+// Gets the first byte after a block's header, where its pieces start.
+static char* ArenaBlockData(ArenaBlock* block)
+{
+	return (char*)block + ArenaAlign(sizeof(ArenaBlock));
+}
+
+static void* ArenaAllocate(size_t size, void* context)
+{
+	Arena* arena = context;
+	size = ArenaAlign(size > 0 ? size : 1);
+
+	// Reuse a released piece of the same size if there is one.
+	if (size <= ARENA_MAX_RECYCLED_SIZE && arena->freeLists[size / ARENA_ALIGNMENT - 1] != NULL)
+	{
+		void** memory = arena->freeLists[size / ARENA_ALIGNMENT - 1];
+		arena->freeLists[size / ARENA_ALIGNMENT - 1] = *memory;
+		return memory;
+	}
+
+	// Start a new block when the current one is full. The rest of the old block is left unused.
+	if (arena->current == NULL || arena->current->size - arena->current->used < size)
+	{
+		size_t blockSize = size > arena->blockSize ? size : arena->blockSize;
+		ArenaBlock* block = malloc(ArenaAlign(sizeof(ArenaBlock)) + blockSize);
+		if (block == NULL)
+			return NULL;
+
+		block->previous = arena->current;
+		block->size = blockSize;
+		block->used = 0;
+		arena->current = block;
+	}
+
+	char* memory = ArenaBlockData(arena->current) + arena->current->used;
+	arena->current->used += size;
+	arena->lastAllocation = memory;
+	return memory;
+}
+
+static void ArenaRelease(void* memory, size_t size, void* context)
+{
+	// The last piece handed out goes straight back to its block, and small pieces are kept for reuse. Anything else
+	// is freed with the arena.
+	Arena* arena = context;
+	size = ArenaAlign(size > 0 ? size : 1);
+	if (memory == arena->lastAllocation)
+	{
+		arena->current->used -= size;
+		arena->lastAllocation = NULL;
+	}
+	else if (size <= ARENA_MAX_RECYCLED_SIZE)
+	{
+		*(void**)memory = arena->freeLists[size / ARENA_ALIGNMENT - 1];
+		arena->freeLists[size / ARENA_ALIGNMENT - 1] = memory;
+	}
+}
+
+static void* ArenaReallocate(void* memory, size_t oldSize, size_t newSize, void* context)
+{
+	Arena* arena = context;
+	if (memory == NULL)
+		return ArenaAllocate(newSize, context);
+
+	// The last piece handed out can change size where it is, if the block has room.
+	if (memory == arena->lastAllocation)
+	{
+		size_t start = (size_t)((char*)memory - ArenaBlockData(arena->current));
+		size_t alignedSize = ArenaAlign(newSize > 0 ? newSize : 1);
+		if (alignedSize <= arena->current->size - start)
+		{
+			arena->current->used = start + alignedSize;
+			return memory;
+		}
+	}
+
+	// Otherwise the memory moves to a new piece, and the old one is released.
+	void* newMemory = ArenaAllocate(newSize, context);
+	if (newMemory != NULL)
+	{
+		memcpy(newMemory, memory, oldSize < newSize ? oldSize : newSize);
+		ArenaRelease(memory, oldSize, context);
+	}
+	return newMemory;
+}
+
+bool ArenaCreate(size_t blockSize, Arena** arena)
+{
+	(*arena) = calloc(1, sizeof(Arena));
+	if ((*arena) == NULL)
+		return false;
+
+	(*arena)->blockSize = blockSize > 0 ? ArenaAlign(blockSize) : DEFAULT_ARENA_BLOCK_SIZE;
+	return true;
+}
+
+void ArenaDestroy(Arena** arena)
+{
+	ArenaReset((*arena));
+	free((*arena)->current);
+	free((*arena));
+	(*arena) = NULL;
+}
+
+void ArenaReset(Arena* arena)
+{
+	if (arena->current == NULL)
+		return;
+
+	// Free every block but the newest, which is reused from the start.
+	ArenaBlock* block = arena->current->previous;
+	while (block != NULL)
+	{
+		ArenaBlock* previous = block->previous;
+		free(block);
+		block = previous;
+	}
+
+	arena->current->previous = NULL;
+	arena->current->used = 0;
+	arena->lastAllocation = NULL;
+	memset(arena->freeLists, 0, sizeof(arena->freeLists));
+}
+
+void ArenaGetAllocator(Arena* arena, Allocator* allocator)
+{
+	allocator->allocate = ArenaAllocate;
+	allocator->reallocate = ArenaReallocate;
+	allocator->release = ArenaRelease;
+	allocator->context = arena;
+}
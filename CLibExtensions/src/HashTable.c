@@ -49,6 +49,8 @@ typedef struct tagHashTable
 	// this percentage of the table, it will be rehashed to be bigger. Defaults to 75% since
 	// Java does it that way.
 	float rehashFactor;
+	// The allocator that the table, its buckets and its keys and values come from.
+	Allocator allocator;
 } HashTable;
 
 // Finds the next prime number after the given number.
@@ -85,6 +87,7 @@ void HashTableDefaultInitData(HashTableInitData* data)
 	data->initialBucketSize = DEFAULT_INITIAL_BUCKET_SIZE;
 	data->hashCodeImpl = NULL;
 	data->keyEqualsImpl = data->valueEqualsImpl = NULL;
+	data->allocator = NULL;
 }
 
 bool HashTableCreate(HashTableInitData* initData, HashTable** hash)
@@ -105,9 +108,13 @@ bool HashTableCreate(HashTableInitData* initData, HashTable** hash)
 	if (initData->rehashFactor > 0 && initData->rehashFactor > 1)
 		return false;
 
-	(*hash) = calloc(1, sizeof(HashTable));
+	const Allocator* allocator = initData->allocator != NULL ? initData->allocator : AllocatorDefault();
+	(*hash) = AllocatorAllocateZeroed(sizeof(HashTable), allocator);
+	if ((*hash) == NULL)
+		return false;
 
 	HashTable* outerHash = (*hash);
+	outerHash->allocator = *allocator;
 	outerHash->dataTypeSize = initData->dataTypeSize;
 	outerHash->keyEqualsFunction = initData->keyEqualsImpl;
 	outerHash->valueEqualsFunction = initData->valueEqualsImpl;
@@ -125,10 +132,10 @@ bool HashTableCreate(HashTableInitData* initData, HashTable** hash)
 	else
 		outerHash->rehashFactor = initData->rehashFactor;
 
-	outerHash->buckets = calloc((*hash)->bucketArrayLength, sizeof(LinkedList*));
+	outerHash->buckets = AllocatorAllocateZeroed(sizeof(LinkedList*) * (*hash)->bucketArrayLength, allocator);
 	for(int i = 0; i < (*hash)->bucketArrayLength; i++)
 	{
-		LinkedListCreate(sizeof(HashTableItem), &outerHash->buckets[i]);
+		LinkedListCreateWithAllocator(sizeof(HashTableItem), allocator, &outerHash->buckets[i]);
 	}
 
 	return true;
@@ -145,16 +152,17 @@ void HashTableDestroy(HashTable** hash)
 		for(int j = 0; j < LinkedListCount(currentList); j++)
 		{
 			HashTableItem* item = LinkedListGet(j, currentList);
-			free(item->key);
-			free(item->value);
+			AllocatorRelease(item->key, item->keySize, &outerHash->allocator);
+			AllocatorRelease(item->value, outerHash->dataTypeSize, &outerHash->allocator);
 		}
 
 		// Destroy will destroy the LinkedList and all the HashTableItem objects in the LinkedList.
 		LinkedListDestroy(&currentList);
 	}
 
-	free(outerHash->buckets);
-	free(outerHash);
+	Allocator allocator = outerHash->allocator;
+	AllocatorRelease(outerHash->buckets, sizeof(LinkedList*) * outerHash->bucketArrayLength, &allocator);
+	AllocatorRelease(outerHash, sizeof(HashTable), &allocator);
 	(*hash) = NULL;
 }
 
@@ -237,8 +245,8 @@ bool HashTableAdd(const void* key, int keyDataSize, const void* value, HashTable
 	// The key did not map to anything, which means it and the value can be safely added.
 	HashTableItem item;
 	item.hashedKeyValue = hashedValue;
-	item.value = calloc(1, hash->dataTypeSize);
-	item.key = calloc(1, keyDataSize);
+	item.value = AllocatorAllocate(hash->dataTypeSize, &hash->allocator);
+	item.key = AllocatorAllocate(keyDataSize, &hash->allocator);
 	item.keySize = keyDataSize;
 	memcpy(item.value, value, hash->dataTypeSize);
 	memcpy(item.key, key, keyDataSize);
@@ -287,8 +295,8 @@ bool HashTableRemove(const void* key, HashTable* hash)
 		if (item->hashedKeyValue == hashCode && hash->keyEqualsFunction(item->key, key))
 		{
 			// Found the item. It needs to be removed.
-			free(item->value);
-			free(item->key);
+			AllocatorRelease(item->value, hash->dataTypeSize, &hash->allocator);
+			AllocatorRelease(item->key, item->keySize, &hash->allocator);
 			LinkedListRemove(i, list);
 			// The number of items decreased by 1.
 			hash->numItems--;
@@ -312,8 +320,8 @@ void HashTableClear(HashTable* hash)
 		for (int j = 0; j < LinkedListCount(list); j++)
 		{
 			HashTableItem* item = LinkedListGet(j, list);
-			free(item->key);
-			free(item->value);
+			AllocatorRelease(item->key, item->keySize, &hash->allocator);
+			AllocatorRelease(item->value, hash->dataTypeSize, &hash->allocator);
 		}
 		
 		// It is now safe to clear the LinkedList. This will destroy all the HashTableItems in the list.
@@ -349,17 +357,19 @@ void HashTableRehash(HashTable* hash)
 	int oldArrayLength = hash->bucketArrayLength;
 	// Double the size of the bucket array, and then round up to the nearest prime number.
 	hash->bucketArrayLength = NextPrimeNumber(hash->bucketArrayLength * 2);
-	hash->buckets = realloc(hash->buckets, sizeof(LinkedList*) * hash->bucketArrayLength);
+	hash->buckets = AllocatorReallocate(hash->buckets, sizeof(LinkedList*) * oldArrayLength,
+										sizeof(LinkedList*) * hash->bucketArrayLength, &hash->allocator);
 
 	// Instantiate a LinkedList object at the new locations.
 	for (int i = oldArrayLength; i < hash->bucketArrayLength; i++)
-		LinkedListCreate(sizeof(HashTableItem), &hash->buckets[i]);
+		LinkedListCreateWithAllocator(sizeof(HashTableItem), &hash->allocator, &hash->buckets[i]);
 
 	// Iterate through all the LinkedLists before the new section of them, pull out the HashTableItem, and
 	// then insert them into a vector for temporary storage. This vector will just store the pointers (so essentially
 	// numbers) for each HashTableItem, instead of the item itself.
 	Vector* hashTableItems;
-	VectorCreate(sizeof(uintptr_t), hash->numItems, hash->numItems, NULL, NULL, &hashTableItems);
+	VectorCreateWithAllocator(sizeof(uintptr_t), hash->numItems, hash->numItems, NULL, NULL, &hash->allocator,
+							  &hashTableItems);
 
 	for(int i = 0; i < oldArrayLength; i++)
 	{
@@ -387,6 +397,8 @@ void HashTableRehash(HashTable* hash)
 		uintptr_t pointerLocation = *(uintptr_t*)VectorGet(i, hashTableItems);
 		HashTableItem* item = (HashTableItem*)pointerLocation;
 		LinkedListPush(item, hash->buckets[item->hashedKeyValue % hash->bucketArrayLength]);
+		// The list copied the item into a node of its own, so the popped copy can go.
+		AllocatorRelease(item, sizeof(HashTableItem), &hash->allocator);
 	}
 
 	// Destroy the vector. This is safe because it will only be deleting void*s, not the items themselves.
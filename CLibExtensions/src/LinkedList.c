@@ -23,14 +23,25 @@ typedef struct tagLinkedList
 	int numItems;
 	// The size of the datatype stored in this LinkedList.
 	int dataTypeSize;
+	// The allocator that the list object, its nodes and their data come from.
+	Allocator allocator;
 } LinkedList;
 
 bool LinkedListCreate(int dataTypeSize, LinkedList** list)
 {
-	(*list) = calloc(1, sizeof(LinkedList));
+	return LinkedListCreateWithAllocator(dataTypeSize, NULL, list);
+}
+
+bool LinkedListCreateWithAllocator(int dataTypeSize, const Allocator* allocator, LinkedList** list)
+{
+	if (allocator == NULL)
+		allocator = AllocatorDefault();
+
+	(*list) = AllocatorAllocateZeroed(sizeof(LinkedList), allocator);
 	if ((*list) == NULL)
 		return false;
 	(*list)->dataTypeSize = dataTypeSize;
+	(*list)->allocator = *allocator;
 	return true;
 }
 
@@ -40,19 +51,41 @@ void LinkedListDestroy(LinkedList** list)
 	LinkedListClear((*list));
 
 	// Destroy the list object.
-	free((*list));
+	Allocator allocator = (*list)->allocator;
+	AllocatorRelease((*list), sizeof(LinkedList), &allocator);
+}
+
+// Creates a node holding a copy of the given value, or returns null if it can't be allocated.
+static LLNode* LinkedListCreateNode(const void* value, LinkedList* list)
+{
+	LLNode* node = AllocatorAllocate(sizeof(LLNode), &list->allocator);
+	if (node == NULL)
+		return NULL;
+	node->next = NULL;
+	node->data = AllocatorAllocate(list->dataTypeSize, &list->allocator);
+	if (node->data == NULL)
+	{
+		AllocatorRelease(node, sizeof(LLNode), &list->allocator);
+		return NULL;
+	}
+	memcpy(node->data, value, list->dataTypeSize);
+	return node;
+}
+
+// Frees a node, and its data if freeData is true.
+static void LinkedListDestroyNode(LLNode* node, bool freeData, LinkedList* list)
+{
+	if (freeData)
+		AllocatorRelease(node->data, list->dataTypeSize, &list->allocator);
+	AllocatorRelease(node, sizeof(LLNode), &list->allocator);
 }
 
 bool LinkedListPush(const void* value, LinkedList* list)
 {
 	// Add a new node at the end of the list.
-	LLNode* node = calloc(1, sizeof(LLNode));
+	LLNode* node = LinkedListCreateNode(value, list);
 	if (node == NULL)
 		return false;
-	node->data = calloc(1, list->dataTypeSize);
-	if (node->data == NULL)
-		return false;
-	memcpy(node->data, value, list->dataTypeSize);
 
 	if (list->head == NULL)
 	{
@@ -84,9 +117,9 @@ bool LinkedListInsert(const void* value, int index, LinkedList* list)
 		return LinkedListPush(value, list);
 
 	// Create the new node.
-	LLNode* newNode = calloc(1, sizeof(LLNode));
-	newNode->data = calloc(1, list->dataTypeSize);
-	memcpy(newNode->data, value, list->dataTypeSize);
+	LLNode* newNode = LinkedListCreateNode(value, list);
+	if (newNode == NULL)
+		return false;
 
 	if(index == 0)
 	{
@@ -127,11 +160,9 @@ bool LinkedListPopInternal(bool eraseData, void** unfreedData, LinkedList* list)
 	if (list->numItems == 1)
 	{
 		// Destroy the node's data, if eraseData is true. Otherwise, output the unfreed data.
-		if (eraseData)
-			free(list->head->data);
-		else
+		if (!eraseData)
 			(*unfreedData) = list->head->data;
-		free(list->head);
+		LinkedListDestroyNode(list->head, eraseData, list);
 		list->head = list->tail = NULL;
 	}
 	else
@@ -147,12 +178,10 @@ bool LinkedListPopInternal(bool eraseData, void** unfreedData, LinkedList* list)
 		list->tail = iterNode;
 
 		// Destroy the doomed node's data, if eraseData is true. If not erasing the data, output the unfreed data.
-		if (eraseData)
-			free(doomedNode->data);
-		else
+		if (!eraseData)
 			(*unfreedData) = doomedNode->data;
 		// Destroy the doomed node.
-		free(doomedNode);
+		LinkedListDestroyNode(doomedNode, eraseData, list);
 	}
 
 	// The number of items in the list goes down by 1.
@@ -191,11 +220,9 @@ bool LinkedListRemoveInternal(int index, bool eraseData, void** unfreedData, Lin
 	{
 		LLNode* newHead = list->head->next;
 		// Free the data of the node is eraseData is true, otherwise output the data.
-		if (eraseData)
-			free(list->head->data);
-		else
+		if (!eraseData)
 			(*unfreedData) = list->head->data;
-		free(list->head);
+		LinkedListDestroyNode(list->head, eraseData, list);
 		list->head = newHead;
 	}
 	else
@@ -215,12 +242,10 @@ bool LinkedListRemoveInternal(int index, bool eraseData, void** unfreedData, Lin
 		doomedNodeLeft->next = doomedNode->next;
 
 		// Free the data of the node if eraseData is true, otherwise, output the data.
-		if (eraseData)
-			free(doomedNode->data);
-		else
+		if (!eraseData)
 			(*unfreedData) = doomedNode->data;
 		// Destroy the node.
-		free(doomedNode);
+		LinkedListDestroyNode(doomedNode, eraseData, list);
 	}
 
 	// The number of nodes has gone down.
@@ -249,15 +274,15 @@ void LinkedListClear(LinkedList* list)
 		LLNode* currentNode = list->head;
 		while (currentNode != NULL)
 		{
-			free(currentNode->data);
 			// Store this node to be deleted after saving the next node.
 			LLNode* doomedNode = currentNode;
 			currentNode = currentNode->next;
-			free(doomedNode);
+			LinkedListDestroyNode(doomedNode, true, list);
 		}
 	}
 
 	// There are now 0 items in the list.
+	list->head = list->tail = NULL;
 	list->numItems = 0;
 }
 
@@ -9,23 +9,35 @@ typedef struct tagStack
 {
 	// The vector that stores all the data.
 	Vector* vect;
+	// The allocator that the stack object and its vector come from.
+	Allocator allocator;
 } Stack;
 
 bool StackCreate(int dataTypeSize, int initialCapacity, int maxStackSize, Stack** stackObj)
+{
+	return StackCreateWithAllocator(dataTypeSize, initialCapacity, maxStackSize, NULL, stackObj);
+}
+
+bool StackCreateWithAllocator(int dataTypeSize, int initialCapacity, int maxStackSize, const Allocator* allocator,
+							  Stack** stackObj)
 {
 	// A valid data type size must be given.
 	if (dataTypeSize <= 0)
 		return false;
+	if (allocator == NULL)
+		allocator = AllocatorDefault();
 
-	*stackObj = calloc(1, sizeof(Stack));
+	*stackObj = AllocatorAllocateZeroed(sizeof(Stack), allocator);
 	if (*stackObj == NULL)
 		return false;
+	(*stackObj)->allocator = *allocator;
 
 	// Instantiate the underlying vector.
 	initialCapacity = initialCapacity <= 0 ? DEFAULT_STACK_INITIAL_CAPACITY : initialCapacity;
-	if (!VectorCreate(dataTypeSize, initialCapacity, maxStackSize, NULL, NULL, &(*stackObj)->vect))
+	if (!VectorCreateWithAllocator(dataTypeSize, initialCapacity, maxStackSize, NULL, NULL, allocator,
+								   &(*stackObj)->vect))
 	{
-		free(*stackObj);
+		AllocatorRelease(*stackObj, sizeof(Stack), allocator);
 		*stackObj = NULL;
 		return false;
 	}
@@ -39,7 +51,8 @@ void StackDestroy(Stack** stackObj)
 	VectorDestroy(&(*stackObj)->vect);
 
 	// Destroy the stack object.
-	free(*stackObj);
+	Allocator allocator = (*stackObj)->allocator;
+	AllocatorRelease(*stackObj, sizeof(Stack), &allocator);
 }
 
 int StackCountItems(Stack* stack)
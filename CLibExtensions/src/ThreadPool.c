@@ -0,0 +1,204 @@
+// sysconf's processor count is a GNU extension.
+#define _GNU_SOURCE
+
+#include "CLib/ThreadPool.h"
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+
+// A job is split into this many chunks per thread, so threads that finish early can take work from slower ones.
+#define CHUNKS_PER_THREAD 4
+
+// The implementation of the thread pool object.
+typedef struct tagThreadPool
+{
+	// The worker threads. The thread that gives a job works on it too, so there is one fewer of these than the pool's
+	// thread count.
+	pthread_t* workers;
+	unsigned int workerCount;
+	// Guards everything below it, and signals the workers when there is a new job or the pool is stopping.
+	pthread_mutex_t lock;
+	pthread_cond_t jobReady;
+	// Signals the thread that gave a job when the last worker is done with it.
+	pthread_cond_t jobDone;
+	// Held for the whole of a job, so jobs given from several threads run one after another.
+	pthread_mutex_t runLock;
+	// Counts up with every job, so a worker can tell a new job from the one it just did.
+	unsigned long jobNumber;
+	// Set when the pool is being destroyed.
+	bool stopping;
+	// The job that is running.
+	ThreadPoolJobFunction* job;
+	void* context;
+	unsigned int count;
+	unsigned int chunkCount;
+	// The next chunk of the job that nobody has taken yet. Taken with an atomic add rather than under the lock.
+	unsigned int nextChunk;
+	// The number of workers that are still working on the job.
+	unsigned int busyWorkers;
+} ThreadPool;
+
+// Takes chunks of the running job until there are none left.
+static void ThreadPoolDoChunks(ThreadPool* pool)
+{
+	unsigned int chunk;
+	while ((chunk = __atomic_fetch_add(&pool->nextChunk, 1, __ATOMIC_RELAXED)) < pool->chunkCount)
+	{
+		unsigned int start = (unsigned int)((unsigned long long)pool->count * chunk / pool->chunkCount);
+		unsigned int end = (unsigned int)((unsigned long long)pool->count * (chunk + 1) / pool->chunkCount);
+		pool->job(chunk, start, end, pool->context);
+	}
+}
+
+// The loop each worker thread runs: wait for a job, work on it, and report back when there's nothing left to take.
+static void* ThreadPoolWorker(void* argument)
+{
+	ThreadPool* pool = argument;
+	unsigned long lastJob = 0;
+
+	pthread_mutex_lock(&pool->lock);
+	while (true)
+	{
+		while (!pool->stopping && pool->jobNumber == lastJob)
+			pthread_cond_wait(&pool->jobReady, &pool->lock);
+		if (pool->stopping)
+			break;
+		lastJob = pool->jobNumber;
+		pthread_mutex_unlock(&pool->lock);
+
+		ThreadPoolDoChunks(pool);
+
+		pthread_mutex_lock(&pool->lock);
+		if (--pool->busyWorkers == 0)
+			pthread_cond_signal(&pool->jobDone);
+	}
+	pthread_mutex_unlock(&pool->lock);
+	return NULL;
+}
+
+// Stops the first workerCount workers and frees the pool.
+static void ThreadPoolStop(unsigned int workerCount, ThreadPool* pool)
+{
+	pthread_mutex_lock(&pool->lock);
+	pool->stopping = true;
+	pthread_cond_broadcast(&pool->jobReady);
+	pthread_mutex_unlock(&pool->lock);
+
+	for (unsigned int i = 0; i < workerCount; i++)
+		pthread_join(pool->workers[i], NULL);
+
+	pthread_mutex_destroy(&pool->lock);
+	pthread_mutex_destroy(&pool->runLock);
+	pthread_cond_destroy(&pool->jobReady);
+	pthread_cond_destroy(&pool->jobDone);
+	free(pool->workers);
+	free(pool);
+}
+
+bool ThreadPoolCreate(unsigned int threadCount, ThreadPool** pool)
+{
+	if (threadCount == 0)
+	{
+		long processorCount = sysconf(_SC_NPROCESSORS_ONLN);
+		threadCount = processorCount > 0 ? (unsigned int)processorCount : 1;
+	}
+
+	(*pool) = calloc(1, sizeof(ThreadPool));
+	if ((*pool) == NULL)
+		return false;
+
+	ThreadPool* newPool = (*pool);
+	newPool->workerCount = threadCount - 1;
+	newPool->workers = calloc(newPool->workerCount > 0 ? newPool->workerCount : 1, sizeof(pthread_t));
+	if (newPool->workers == NULL)
+	{
+		free(newPool);
+		(*pool) = NULL;
+		return false;
+	}
+
+	pthread_mutex_init(&newPool->lock, NULL);
+	pthread_mutex_init(&newPool->runLock, NULL);
+	pthread_cond_init(&newPool->jobReady, NULL);
+	pthread_cond_init(&newPool->jobDone, NULL);
+
+	for (unsigned int i = 0; i < newPool->workerCount; i++)
+	{
+		if (pthread_create(&newPool->workers[i], NULL, ThreadPoolWorker, newPool) != 0)
+		{
+			// Stop the workers that did start.
+			ThreadPoolStop(i, newPool);
+			(*pool) = NULL;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void ThreadPoolDestroy(ThreadPool** pool)
+{
+	ThreadPoolStop((*pool)->workerCount, (*pool));
+	(*pool) = NULL;
+}
+
+unsigned int ThreadPoolCountThreads(ThreadPool* pool)
+{
+	return pool != NULL ? pool->workerCount + 1 : 1;
+}
+
+unsigned int ThreadPoolCountChunks(unsigned int count, unsigned int minChunkSize, ThreadPool* pool)
+{
+	if (count == 0)
+		return 0;
+
+	// A single thread has no one to share the work with.
+	unsigned int threadCount = ThreadPoolCountThreads(pool);
+	if (threadCount == 1)
+		return 1;
+
+	// As many chunks as keep the threads busy, but no more than can each hold minChunkSize indices.
+	minChunkSize = minChunkSize > 0 ? minChunkSize : 1;
+	unsigned int chunkCount = count / minChunkSize;
+	if (chunkCount > threadCount * CHUNKS_PER_THREAD)
+		chunkCount = threadCount * CHUNKS_PER_THREAD;
+	return chunkCount > 0 ? chunkCount : 1;
+}
+
+void ThreadPoolRun(unsigned int count, unsigned int minChunkSize, ThreadPoolJobFunction* job, void* context,
+				   ThreadPool* pool)
+{
+	unsigned int chunkCount = ThreadPoolCountChunks(count, minChunkSize, pool);
+	if (chunkCount == 0)
+		return;
+
+	// A job of one chunk isn't worth waking the workers for.
+	if (chunkCount == 1)
+	{
+		job(0, 0, count, context);
+		return;
+	}
+
+	pthread_mutex_lock(&pool->runLock);
+
+	pthread_mutex_lock(&pool->lock);
+	pool->job = job;
+	pool->context = context;
+	pool->count = count;
+	pool->chunkCount = chunkCount;
+	pool->nextChunk = 0;
+	pool->busyWorkers = pool->workerCount;
+	pool->jobNumber++;
+	pthread_cond_broadcast(&pool->jobReady);
+	pthread_mutex_unlock(&pool->lock);
+
+	// Work on the job alongside the workers, then wait for the ones still finishing their last chunk.
+	ThreadPoolDoChunks(pool);
+
+	pthread_mutex_lock(&pool->lock);
+	while (pool->busyWorkers > 0)
+		pthread_cond_wait(&pool->jobDone, &pool->lock);
+	pthread_mutex_unlock(&pool->lock);
+
+	pthread_mutex_unlock(&pool->runLock);
+}
@@ -0,0 +1,405 @@
+#include "CLib/TimingWheel.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+// The wheel is made of WHEEL_LEVELS levels of WHEEL_SLOTS slots each. Level k holds timers whose expiry time shares
+// every bit above the lowest (k + 1) * WHEEL_SLOT_BITS bits with the current time, so 4 levels of 8 bits cover the
+// whole range of an unsigned int and no overflow list is needed.
+#define WHEEL_SLOT_BITS 8
+#define WHEEL_SLOTS (1 << WHEEL_SLOT_BITS)
+#define WHEEL_SLOT_MASK (WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS 4
+
+// The number of 64 bit words needed for a bitmap with one bit per slot.
+#define WHEEL_BITMAP_WORDS (WHEEL_SLOTS / 64)
+
+// Every slot is a list. One extra list holds timers that have expired but were not popped yet.
+#define WHEEL_EXPIRED_LIST (WHEEL_LEVELS * WHEEL_SLOTS)
+#define WHEEL_LIST_COUNT (WHEEL_EXPIRED_LIST + 1)
+
+// Marks the end of a list, or a node that is not in any list.
+#define WHEEL_NONE -1
+
+// The number of timer nodes the wheel starts with.
+#define DEFAULT_INITIAL_NODE_CAPACITY 64
+
+// A single timer. Nodes live in one array and are linked together by index, which keeps handles stable while the
+// array grows.
+typedef struct tagTimerNode
+{
+	// The time at which this timer expires.
+	unsigned int expiryTime;
+	// The list this node is in, or WHEEL_NONE if the node is free.
+	int list;
+	// The previous node in the list.
+	int prev;
+	// The next node in the list, or the next free node if this node is free.
+	int next;
+} TimerNode;
+
+typedef struct tagTimingWheel
+{
+	// The size of the data carried by each timer.
+	unsigned int dataTypeSize;
+	// The current time of the wheel.
+	unsigned int currentTime;
+	// The number of timers in the wheel, including expired ones that were not popped.
+	int numTimers;
+	// The first and last node of every list.
+	int heads[WHEEL_LIST_COUNT];
+	int tails[WHEEL_LIST_COUNT];
+	// One bit per slot, set when the slot's list is not empty. Used to skip over empty stretches of time.
+	uint64_t occupied[WHEEL_LEVELS][WHEEL_BITMAP_WORDS];
+	// The timer nodes, and the data for each node stored in a parallel array.
+	TimerNode* nodes;
+	unsigned char* nodeData;
+	// The number of nodes allocated, and the number of nodes there is data allocated for. The arrays grow one after
+	// the other, so if growing the second fails they are left different sizes; the wheel uses the smaller.
+	int nodeCapacity;
+	int nodeDataCapacity;
+	// The number of nodes that have ever been handed out. Nodes past this index have never been used.
+	int nodesUsed;
+	// The first free node that can be reused.
+	int freeList;
+	// The allocator that the wheel and its node arrays come from.
+	Allocator allocator;
+} TimingWheel;
+
+// Finds the index of the lowest set bit in a non-zero word.
+static int LowestSetBit(uint64_t word)
+{
+#if defined(__GNUC__)
+	return __builtin_ctzll(word);
+#else
+	int index = 0;
+	while ((word & 1) == 0)
+	{
+		word >>= 1;
+		index++;
+	}
+	return index;
+#endif
+}
+
+// Finds the first occupied slot after startSlot on the given level. Returns WHEEL_NONE if there is none.
+static int NextOccupiedSlot(int level, int startSlot, TimingWheel* wheel)
+{
+	int slot = startSlot + 1;
+	while (slot < WHEEL_SLOTS)
+	{
+		// Mask off the bits of the word that come before the slot being searched from.
+		uint64_t word = wheel->occupied[level][slot / 64] & (~(uint64_t)0 << (slot % 64));
+		if (word != 0)
+			return (slot & ~63) + LowestSetBit(word);
+		slot = (slot & ~63) + 64;
+	}
+	return WHEEL_NONE;
+}
+
+static void ListAppend(int nodeIndex, int list, TimingWheel* wheel)
+{
+	TimerNode* node = &wheel->nodes[nodeIndex];
+	node->list = list;
+	node->next = WHEEL_NONE;
+	node->prev = wheel->tails[list];
+
+	if (wheel->tails[list] == WHEEL_NONE)
+		wheel->heads[list] = nodeIndex;
+	else
+		wheel->nodes[wheel->tails[list]].next = nodeIndex;
+	wheel->tails[list] = nodeIndex;
+
+	// Mark the slot as occupied.
+	if (list != WHEEL_EXPIRED_LIST)
+		wheel->occupied[list / WHEEL_SLOTS][(list % WHEEL_SLOTS) / 64] |= (uint64_t)1 << (list % 64);
+}
+
+static void ListUnlink(int nodeIndex, TimingWheel* wheel)
+{
+	TimerNode* node = &wheel->nodes[nodeIndex];
+	int list = node->list;
+
+	if (node->prev == WHEEL_NONE)
+		wheel->heads[list] = node->next;
+	else
+		wheel->nodes[node->prev].next = node->next;
+	if (node->next == WHEEL_NONE)
+		wheel->tails[list] = node->prev;
+	else
+		wheel->nodes[node->next].prev = node->prev;
+
+	// Clear the slot's occupied bit if that was the last node in it.
+	if (list != WHEEL_EXPIRED_LIST && wheel->heads[list] == WHEEL_NONE)
+		wheel->occupied[list / WHEEL_SLOTS][(list % WHEEL_SLOTS) / 64] &= ~((uint64_t)1 << (list % 64));
+}
+
+// Places a node into the list it belongs in, based on its expiry time and the current time of the wheel.
+static void PlaceNode(int nodeIndex, TimingWheel* wheel)
+{
+	unsigned int expiryTime = wheel->nodes[nodeIndex].expiryTime;
+	if (expiryTime <= wheel->currentTime)
+	{
+		ListAppend(nodeIndex, WHEEL_EXPIRED_LIST, wheel);
+		return;
+	}
+
+	// The level is picked by the highest bits in which the expiry time differs from the current time.
+	unsigned int difference = expiryTime ^ wheel->currentTime;
+	int level = 0;
+	while (level < WHEEL_LEVELS - 1 && (difference >> (WHEEL_SLOT_BITS * (level + 1))) != 0)
+		level++;
+
+	int slot = (expiryTime >> (WHEEL_SLOT_BITS * level)) & WHEEL_SLOT_MASK;
+	ListAppend(nodeIndex, level * WHEEL_SLOTS + slot, wheel);
+}
+
+// Moves all the timers in one slot down to the lower levels. Timers keep their relative order.
+static void CascadeSlot(int level, int slot, TimingWheel* wheel)
+{
+	int list = level * WHEEL_SLOTS + slot;
+	int nodeIndex = wheel->heads[list];
+
+	// Detach the whole list first, since placing a node rewrites its links.
+	wheel->heads[list] = wheel->tails[list] = WHEEL_NONE;
+	wheel->occupied[level][slot / 64] &= ~((uint64_t)1 << (slot % 64));
+
+	while (nodeIndex != WHEEL_NONE)
+	{
+		int next = wheel->nodes[nodeIndex].next;
+		PlaceNode(nodeIndex, wheel);
+		nodeIndex = next;
+	}
+}
+
+// Returns a node to the free list.
+static void FreeNode(int nodeIndex, TimingWheel* wheel)
+{
+	wheel->nodes[nodeIndex].list = WHEEL_NONE;
+	wheel->nodes[nodeIndex].next = wheel->freeList;
+	wheel->freeList = nodeIndex;
+	wheel->numTimers--;
+}
+
+bool TimingWheelCreate(unsigned int dataTypeSize, unsigned int startTime, TimingWheel** wheel)
+{
+	return TimingWheelCreateWithAllocator(dataTypeSize, startTime, NULL, wheel);
+}
+
+bool TimingWheelCreateWithAllocator(unsigned int dataTypeSize, unsigned int startTime, const Allocator* allocator,
+									TimingWheel** wheel)
+{
+	if (dataTypeSize <= 0)
+		return false;
+	if (allocator == NULL)
+		allocator = AllocatorDefault();
+
+	*wheel = AllocatorAllocateZeroed(sizeof(TimingWheel), allocator);
+	if (*wheel == NULL)
+		return false;
+
+	TimingWheel* newWheel = *wheel;
+	newWheel->allocator = *allocator;
+	newWheel->dataTypeSize = dataTypeSize;
+	newWheel->currentTime = startTime;
+	newWheel->freeList = WHEEL_NONE;
+	for (int i = 0; i < WHEEL_LIST_COUNT; i++)
+		newWheel->heads[i] = newWheel->tails[i] = WHEEL_NONE;
+
+	newWheel->nodes = AllocatorAllocate(sizeof(TimerNode) * DEFAULT_INITIAL_NODE_CAPACITY, allocator);
+	if (newWheel->nodes != NULL)
+		newWheel->nodeCapacity = DEFAULT_INITIAL_NODE_CAPACITY;
+	newWheel->nodeData = AllocatorAllocate((size_t)dataTypeSize * DEFAULT_INITIAL_NODE_CAPACITY, allocator);
+	if (newWheel->nodeData != NULL)
+		newWheel->nodeDataCapacity = DEFAULT_INITIAL_NODE_CAPACITY;
+	if (newWheel->nodes == NULL || newWheel->nodeData == NULL)
+	{
+		TimingWheelDestroy(wheel);
+		return false;
+	}
+
+	return true;
+}
+
+void TimingWheelDestroy(TimingWheel** wheel)
+{
+	Allocator allocator = (*wheel)->allocator;
+	AllocatorRelease((*wheel)->nodes, sizeof(TimerNode) * (*wheel)->nodeCapacity, &allocator);
+	AllocatorRelease((*wheel)->nodeData, (size_t)(*wheel)->dataTypeSize * (*wheel)->nodeDataCapacity, &allocator);
+	AllocatorRelease(*wheel, sizeof(TimingWheel), &allocator);
+	*wheel = NULL;
+}
+
+bool TimingWheelSchedule(const void* data, unsigned int expiryTime, TimerHandle* handle, TimingWheel* wheel)
+{
+	// Reuse a free node if there is one, otherwise take a node that was never used, growing the arrays if needed.
+	int nodeIndex = wheel->freeList;
+	if (nodeIndex != WHEEL_NONE)
+	{
+		wheel->freeList = wheel->nodes[nodeIndex].next;
+	}
+	else
+	{
+		int capacity = wheel->nodeCapacity < wheel->nodeDataCapacity ? wheel->nodeCapacity : wheel->nodeDataCapacity;
+		if (wheel->nodesUsed == capacity)
+		{
+			// Each array records its own size as soon as it grows, so the sizes given to the allocator stay right
+			// even if growing the other array fails. An array that grew last time is not grown again.
+			int newCapacity = capacity * 2;
+			if (wheel->nodeCapacity < newCapacity)
+			{
+				TimerNode* newNodes = AllocatorReallocate(wheel->nodes, sizeof(TimerNode) * wheel->nodeCapacity,
+														  sizeof(TimerNode) * newCapacity, &wheel->allocator);
+				if (newNodes == NULL)
+					return false;
+				wheel->nodes = newNodes;
+				wheel->nodeCapacity = newCapacity;
+			}
+
+			if (wheel->nodeDataCapacity < newCapacity)
+			{
+				unsigned char* newData = AllocatorReallocate(wheel->nodeData,
+															 (size_t)wheel->dataTypeSize * wheel->nodeDataCapacity,
+															 (size_t)wheel->dataTypeSize * newCapacity,
+															 &wheel->allocator);
+				if (newData == NULL)
+					return false;
+				wheel->nodeData = newData;
+				wheel->nodeDataCapacity = newCapacity;
+			}
+		}
+		nodeIndex = wheel->nodesUsed++;
+	}
+
+	wheel->nodes[nodeIndex].expiryTime = expiryTime;
+	memcpy(wheel->nodeData + (size_t)wheel->dataTypeSize * nodeIndex, data, wheel->dataTypeSize);
+	PlaceNode(nodeIndex, wheel);
+	wheel->numTimers++;
+
+	if (handle != NULL)
+		*handle = nodeIndex;
+
+	return true;
+}
+
+bool TimingWheelCancel(TimerHandle handle, TimingWheel* wheel)
+{
+	// The handle must refer to a node that is currently in a list.
+	if (handle < 0 || handle >= wheel->nodesUsed || wheel->nodes[handle].list == WHEEL_NONE)
+		return false;
+
+	ListUnlink(handle, wheel);
+	FreeNode(handle, wheel);
+	return true;
+}
+
+void TimingWheelAdvance(unsigned int time, TimingWheel* wheel)
+{
+	while (wheel->currentTime < time)
+	{
+		// Find the next point in time where something happens: either a level 0 slot fires, or a slot of a higher
+		// level needs to be cascaded down. Each level is only searched up to the end of its current rotation, since
+		// the next rotation starts with a cascade from the level above it. 64 bit math keeps this from overflowing.
+		uint64_t nextEvent = UINT64_MAX;
+		for (int level = 0; level < WHEEL_LEVELS; level++)
+		{
+			int shift = WHEEL_SLOT_BITS * level;
+			int currentSlot = (wheel->currentTime >> shift) & WHEEL_SLOT_MASK;
+			int slot = NextOccupiedSlot(level, currentSlot, wheel);
+			if (slot == WHEEL_NONE)
+				continue;
+
+			uint64_t rotationStart = (uint64_t)wheel->currentTime & ~(((uint64_t)1 << (shift + WHEEL_SLOT_BITS)) - 1);
+			uint64_t eventTime = rotationStart + ((uint64_t)slot << shift);
+			if (eventTime < nextEvent)
+				nextEvent = eventTime;
+		}
+
+		// Nothing happens before the target time, so jump straight to it.
+		if (nextEvent > time)
+		{
+			wheel->currentTime = time;
+			break;
+		}
+		wheel->currentTime = (unsigned int)nextEvent;
+
+		// Cascade from the top down, so that timers moved out of a higher level land in the lower level slots
+		// that are about to be cascaded themselves.
+		for (int level = WHEEL_LEVELS - 1; level > 0; level--)
+		{
+			int shift = WHEEL_SLOT_BITS * level;
+			if ((wheel->currentTime & ((1u << shift) - 1)) == 0)
+				CascadeSlot(level, (wheel->currentTime >> shift) & WHEEL_SLOT_MASK, wheel);
+		}
+
+		// Everything in the level 0 slot for the current time has now expired.
+		CascadeSlot(0, wheel->currentTime & WHEEL_SLOT_MASK, wheel);
+	}
+}
+
+bool TimingWheelPopExpired(void* data, unsigned int* expiryTime, TimingWheel* wheel)
+{
+	int nodeIndex = wheel->heads[WHEEL_EXPIRED_LIST];
+	if (nodeIndex == WHEEL_NONE)
+		return false;
+
+	if (data != NULL)
+		memcpy(data, wheel->nodeData + (size_t)wheel->dataTypeSize * nodeIndex, wheel->dataTypeSize);
+	if (expiryTime != NULL)
+		*expiryTime = wheel->nodes[nodeIndex].expiryTime;
+
+	ListUnlink(nodeIndex, wheel);
+	FreeNode(nodeIndex, wheel);
+	return true;
+}
+
+bool TimingWheelNextExpiry(unsigned int* expiryTime, TimingWheel* wheel)
+{
+	// Lower levels always hold earlier timers than higher levels, so the first occupied slot found on the lowest
+	// level holds the earliest timer. Only level 0 slots hold a single expiry time; a higher level slot has to be
+	// searched for its earliest timer.
+	for (int level = 0; level < WHEEL_LEVELS; level++)
+	{
+		int currentSlot = (wheel->currentTime >> (WHEEL_SLOT_BITS * level)) & WHEEL_SLOT_MASK;
+		int slot = NextOccupiedSlot(level, currentSlot, wheel);
+		if (slot == WHEEL_NONE)
+			continue;
+
+		int nodeIndex = wheel->heads[level * WHEEL_SLOTS + slot];
+		unsigned int earliest = wheel->nodes[nodeIndex].expiryTime;
+		for (; nodeIndex != WHEEL_NONE; nodeIndex = wheel->nodes[nodeIndex].next)
+			if (wheel->nodes[nodeIndex].expiryTime < earliest)
+				earliest = wheel->nodes[nodeIndex].expiryTime;
+
+		*expiryTime = earliest;
+		return true;
+	}
+
+	return false;
+}
+
+unsigned int TimingWheelCurrentTime(TimingWheel* wheel)
+{
+	return wheel->currentTime;
+}
+
+int TimingWheelCount(TimingWheel* wheel)
+{
+	return wheel->numTimers;
+}
+
+bool TimingWheelIsEmpty(TimingWheel* wheel)
+{
+	return (wheel->numTimers == 0);
+}
+
+void TimingWheelClear(TimingWheel* wheel)
+{
+	// Forgetting every node is enough; they will be handed out again from the start of the node array.
+	for (int i = 0; i < WHEEL_LIST_COUNT; i++)
+		wheel->heads[i] = wheel->tails[i] = WHEEL_NONE;
+	memset(wheel->occupied, 0, sizeof(wheel->occupied));
+	wheel->freeList = WHEEL_NONE;
+	wheel->nodesUsed = 0;
+	wheel->numTimers = 0;
+}
@@ -1,7 +1,18 @@
+// Mapped vectors grow with mremap, which is a GNU extension.
+#define _GNU_SOURCE
+
 #include "CLib/Vector.h"
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <limits.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 // The implementation of the vector object.
 typedef struct tagVector
@@ -20,56 +31,381 @@ typedef struct tagVector
 	CompareToFunction* compareFunction;
 	// An equals implementation to check  if two objects are considered the same.
 	EqualsFunction* equalsFunction;
+	// How many times bigger the vector gets each time it runs out of room.
+	float growthFactor;
+	// The file that the data is mapped from, or -1 if the data is on the heap.
+	int fileDescriptor;
+	// The allocator that the vector object and its data come from.
+	Allocator allocator;
 } Vector;
 
+// By default a full vector grows to three times its size.
+#define DEFAULT_VECTOR_GROWTH_FACTOR 3.0f
+
 bool VectorCreate(unsigned int dataTypeSize, unsigned int initialCapacity, unsigned int maxCapacity,
 				  EqualsFunction* equalsImpl, CompareToFunction* compareImpl, Vector** vect)
+{
+	return VectorCreateWithAllocator(dataTypeSize, initialCapacity, maxCapacity, equalsImpl, compareImpl, NULL, vect);
+}
+
+bool VectorCreateWithAllocator(unsigned int dataTypeSize, unsigned int initialCapacity, unsigned int maxCapacity,
+							   EqualsFunction* equalsImpl, CompareToFunction* compareImpl, const Allocator* allocator,
+							   Vector** vect)
 {
 	if (dataTypeSize <= 0)
 		return false;
 	if (initialCapacity < 0)
 		return false;
+	if (allocator == NULL)
+		allocator = AllocatorDefault();
 
 	// Create a new vector object.
-	(*vect) = calloc(1, sizeof(Vector));
+	(*vect) = AllocatorAllocateZeroed(sizeof(Vector), allocator);
+	if ((*vect) == NULL)
+		return false;
 	(*vect)->dataTypeSize = dataTypeSize;
 	(*vect)->maxCapacity = maxCapacity;
 	(*vect)->numItems = 0;
 	(*vect)->currentCapacity = initialCapacity;
 	(*vect)->compareFunction = compareImpl;
 	(*vect)->equalsFunction = equalsImpl;
-	(*vect)->data = calloc(initialCapacity, dataTypeSize);
+	(*vect)->growthFactor = DEFAULT_VECTOR_GROWTH_FACTOR;
+	(*vect)->fileDescriptor = -1;
+	(*vect)->allocator = *allocator;
+	(*vect)->data = AllocatorAllocateZeroed((size_t)initialCapacity * dataTypeSize, allocator);
+	if ((*vect)->data == NULL && initialCapacity > 0)
+	{
+		AllocatorRelease((*vect), sizeof(Vector), allocator);
+		(*vect) = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+#ifndef _WIN32
+
+// Changes the capacity of a mapped vector, resizing both the file and the mapping. The file grows before the mapping
+// and shrinks after it, so no part of the mapping is ever past the end of the file.
+static bool VectorRemap(unsigned int capacity, Vector* vect)
+{
+	size_t oldBytes = (size_t)vect->currentCapacity * vect->dataTypeSize;
+	size_t newBytes = (size_t)capacity * vect->dataTypeSize;
+
+	if (newBytes > oldBytes && ftruncate(vect->fileDescriptor, (off_t)newBytes) == -1)
+		return false;
+
+	void* data = NULL;
+	if (newBytes == 0)
+	{
+		if (oldBytes > 0)
+			munmap(vect->data, oldBytes);
+	}
+	else if (oldBytes == 0)
+		data = mmap(NULL, newBytes, PROT_READ | PROT_WRITE, MAP_SHARED, vect->fileDescriptor, 0);
+	else
+	{
+#ifdef __linux__
+		data = mremap(vect->data, oldBytes, newBytes, MREMAP_MAYMOVE);
+#else
+		// Without mremap the file is mapped again; the items are in the file, so nothing is copied.
+		data = mmap(NULL, newBytes, PROT_READ | PROT_WRITE, MAP_SHARED, vect->fileDescriptor, 0);
+		if (data != MAP_FAILED)
+			munmap(vect->data, oldBytes);
+#endif
+	}
+
+	if (data == MAP_FAILED)
+	{
+		if (newBytes > oldBytes)
+			ftruncate(vect->fileDescriptor, (off_t)oldBytes);
+		return false;
+	}
+
+	// If the file can't be shrunk it keeps its old size, which does no harm; it is trimmed when the vector is destroyed.
+	if (newBytes < oldBytes)
+		ftruncate(vect->fileDescriptor, (off_t)newBytes);
+
+	vect->data = data;
+	vect->currentCapacity = capacity;
+	return true;
+}
+
+#endif
+
+bool VectorCreateMapped(const char* path, unsigned int dataTypeSize, unsigned int initialCapacity,
+						unsigned int maxCapacity, EqualsFunction* equalsImpl, CompareToFunction* compareImpl,
+						Vector** vect)
+{
+#ifdef _WIN32
+	// Mapped vectors are only supported on POSIX systems.
+	return false;
+#else
+	if (dataTypeSize <= 0)
+		return false;
+
+	int fileDescriptor = open(path, O_RDWR | O_CREAT, 0644);
+	if (fileDescriptor == -1)
+		return false;
+
+	// A file that already exists holds the items of a vector that was mapped from it before.
+	struct stat fileStats;
+	if (fstat(fileDescriptor, &fileStats) == -1 || (unsigned long long)fileStats.st_size / dataTypeSize > UINT_MAX)
+	{
+		close(fileDescriptor);
+		return false;
+	}
+	unsigned int existingItems = (unsigned int)((unsigned long long)fileStats.st_size / dataTypeSize);
+
+	// Only the items are mapped; the vector object itself comes from the default allocator.
+	(*vect) = AllocatorAllocateZeroed(sizeof(Vector), AllocatorDefault());
+	if ((*vect) == NULL)
+	{
+		close(fileDescriptor);
+		return false;
+	}
+	(*vect)->allocator = *AllocatorDefault();
+	(*vect)->dataTypeSize = dataTypeSize;
+	(*vect)->maxCapacity = maxCapacity;
+	(*vect)->compareFunction = compareImpl;
+	(*vect)->equalsFunction = equalsImpl;
+	(*vect)->growthFactor = DEFAULT_VECTOR_GROWTH_FACTOR;
+	(*vect)->fileDescriptor = fileDescriptor;
+
+	// Map the whole file, plus room for the initial capacity. Any part of the file past the last whole item is cut
+	// off; the capacity starts at zero so the file is sized to fit exactly.
+	if (ftruncate(fileDescriptor, (off_t)((size_t)existingItems * dataTypeSize)) == -1 ||
+		!VectorRemap(existingItems > initialCapacity ? existingItems : initialCapacity, (*vect)))
+	{
+		close(fileDescriptor);
+		AllocatorRelease((*vect), sizeof(Vector), AllocatorDefault());
+		(*vect) = NULL;
+		return false;
+	}
+	(*vect)->numItems = existingItems;
 
 	return true;
+#endif
+}
+
+bool VectorSync(Vector* vect)
+{
+#ifdef _WIN32
+	return true;
+#else
+	// Only a mapped vector has anywhere to write its items to.
+	if (vect->fileDescriptor == -1 || vect->numItems == 0)
+		return true;
+
+	return msync(vect->data, (size_t)vect->numItems * vect->dataTypeSize, MS_SYNC) == 0;
+#endif
+}
+
+bool VectorIsMapped(Vector* vect)
+{
+	return vect->fileDescriptor != -1;
 }
 
 void VectorDestroy(Vector** vect)
 {
+#ifndef _WIN32
+	if ((*vect)->fileDescriptor != -1)
+	{
+		// Unmap the data and trim the file to the items, so it can be mapped again later to get the same items back.
+		if ((*vect)->currentCapacity > 0)
+			munmap((*vect)->data, (size_t)(*vect)->currentCapacity * (*vect)->dataTypeSize);
+		ftruncate((*vect)->fileDescriptor, (off_t)((size_t)(*vect)->numItems * (*vect)->dataTypeSize));
+		close((*vect)->fileDescriptor);
+		(*vect)->data = NULL;
+	}
+#endif
+
 	// Destroy the actual data array.
-	free((*vect)->data);
+	Allocator allocator = (*vect)->allocator;
+	AllocatorRelease((*vect)->data, (size_t)(*vect)->currentCapacity * (*vect)->dataTypeSize, &allocator);
 	// Destroy the vector object.
-	free((*vect));
+	AllocatorRelease((*vect), sizeof(Vector), &allocator);
 	(*vect) = NULL;
 }
 
-bool VectorAdd(const void* data, Vector* vect)
+// Changes the capacity of the vector, which has to be at least the number of items in it.
+static bool VectorSetCapacity(unsigned int capacity, Vector* vect)
 {
-	// If a max capacity was set and adding an item would exceed that max capacity, return false.
-	if (vect->maxCapacity > 0 && vect->maxCapacity < vect->numItems + 1)
+#ifndef _WIN32
+	if (vect->fileDescriptor != -1)
+		return VectorRemap(capacity, vect);
+#endif
+
+	size_t oldBytes = (size_t)vect->currentCapacity * vect->dataTypeSize;
+
+	// An empty vector gives back all of its storage.
+	if (capacity == 0)
+	{
+		AllocatorRelease(vect->data, oldBytes, &vect->allocator);
+		vect->data = NULL;
+		vect->currentCapacity = 0;
+		return true;
+	}
+
+	void* data = AllocatorReallocate(vect->data, oldBytes, (size_t)capacity * vect->dataTypeSize, &vect->allocator);
+	if (data == NULL)
+		return false;
+
+	vect->data = data;
+	vect->currentCapacity = capacity;
+	return true;
+}
+
+// Replaces the items of the vector with the ones in data, a buffer with room for currentCapacity items that the vector
+// then owns. A mapped vector keeps its mapping, so the items are copied into it and the buffer is freed instead.
+static void VectorTakeData(char* data, Vector* vect)
+{
+	if (vect->fileDescriptor != -1)
+	{
+		memcpy(vect->data, data, (size_t)vect->numItems * vect->dataTypeSize);
+		AllocatorRelease(data, (size_t)vect->currentCapacity * vect->dataTypeSize, &vect->allocator);
+		return;
+	}
+
+	AllocatorRelease(vect->data, (size_t)vect->currentCapacity * vect->dataTypeSize, &vect->allocator);
+	vect->data = data;
+}
+
+bool VectorReserve(unsigned int capacity, Vector* vect)
+{
+	if (capacity <= vect->currentCapacity)
+		return true;
+
+	// If a max capacity was set, the vector can't hold more than that.
+	if (vect->maxCapacity > 0 && vect->maxCapacity < capacity)
 		return false;
 
-	if (vect->currentCapacity < vect->numItems + 1)
+	return VectorSetCapacity(capacity, vect);
+}
+
+// Makes room for at least minCapacity items, growing the vector by its growth factor so that adding items one at a
+// time only reallocates now and then.
+static bool VectorGrow(unsigned int minCapacity, Vector* vect)
+{
+	if (minCapacity <= vect->currentCapacity)
+		return true;
+
+	// Since the current capacity can be zero, grow as if it were at least one.
+	unsigned long long capacity = vect->currentCapacity +
+		(unsigned long long)((vect->currentCapacity > 0 ? vect->currentCapacity : 1) * (vect->growthFactor - 1.0));
+	if (capacity < minCapacity)
+		capacity = minCapacity;
+	if (vect->maxCapacity > 0 && capacity > vect->maxCapacity)
+		capacity = vect->maxCapacity;
+	if (capacity > UINT_MAX)
+		capacity = UINT_MAX;
+
+	return VectorReserve((unsigned int)capacity, vect);
+}
+
+bool VectorShrinkToFit(Vector* vect)
+{
+	if (vect->currentCapacity == vect->numItems)
+		return true;
+
+	return VectorSetCapacity(vect->numItems, vect);
+}
+
+bool VectorResize(unsigned int count, Vector* vect)
+{
+	if (count > vect->numItems)
 	{
-		// Need to increase the capacity of the vector. Since initial capacity can be a zero, take that into account.
-		vect->currentCapacity += (vect->currentCapacity > 0 ? vect->currentCapacity : 1) * 2;
-		vect->data = realloc(vect->data, vect->currentCapacity * vect->dataTypeSize);
+		if (!VectorReserve(count, vect))
+			return false;
+
+		// New items start out zeroed, like the storage of a new vector.
+		memset((char*)vect->data + ((size_t)vect->dataTypeSize * vect->numItems), 0,
+			(size_t)vect->dataTypeSize * (count - vect->numItems));
 	}
 
-	// Add this item to the vector, copying the data since the item is likely stack allocated.
-	memcpy((char*)vect->data + (vect->dataTypeSize * vect->numItems), data, vect->dataTypeSize);
+	vect->numItems = count;
+	return true;
+}
 
-	// The size of the vector increased.
+bool VectorSetGrowthFactor(float growthFactor, Vector* vect)
+{
+	// The vector has to get bigger each time it grows.
+	if (!(growthFactor > 1.0f))
+		return false;
+
+	vect->growthFactor = growthFactor;
+	return true;
+}
+
+void* VectorEmplaceBack(Vector* vect)
+{
+	// If a max capacity was set and adding an item would exceed that max capacity, return null.
+	if (vect->maxCapacity > 0 && vect->maxCapacity < vect->numItems + 1)
+		return NULL;
+
+	if (!VectorGrow(vect->numItems + 1, vect))
+		return NULL;
+
+	// The size of the vector increased, and the caller fills in the new item.
 	vect->numItems++;
+	return (char*)vect->data + ((size_t)vect->dataTypeSize * (vect->numItems - 1));
+}
+
+bool VectorAdd(const void* data, Vector* vect)
+{
+	void* item = VectorEmplaceBack(vect);
+	if (item == NULL)
+		return false;
+
+	// Add this item to the vector, copying the data since the item is likely stack allocated.
+	memcpy(item, data, vect->dataTypeSize);
+
+	return true;
+}
+
+bool VectorAddRange(const void* data, unsigned int count, Vector* vect)
+{
+	if (count == 0)
+		return true;
+
+	// If a max capacity was set and adding the items would exceed that max capacity, return false.
+	if (vect->maxCapacity > 0 && vect->maxCapacity - vect->numItems < count)
+		return false;
+
+	if (!VectorGrow(vect->numItems + count, vect))
+		return false;
+
+	// Copy all the items onto the end of the vector at once.
+	memcpy((char*)vect->data + ((size_t)vect->dataTypeSize * vect->numItems), data, (size_t)vect->dataTypeSize * count);
+
+	vect->numItems += count;
+
+	return true;
+}
+
+bool VectorInsertRange(const void* data, unsigned int count, int index, Vector* vect)
+{
+	// If the insert index is not valid, return false.
+	if (index < 0 || index > vect->numItems)
+		return false;
+	if (count == 0)
+		return true;
+
+	// If a max capacity was set and adding the items would exceed that max capacity, return false.
+	if (vect->maxCapacity > 0 && vect->maxCapacity - vect->numItems < count)
+		return false;
+
+	if (!VectorGrow(vect->numItems + count, vect))
+		return false;
+
+	// Shift the elements to the right of the insertion index right by count, once, and copy the items into the gap.
+	memmove(
+		(char*)vect->data + ((size_t)vect->dataTypeSize * (index + count)),
+		(char*)vect->data + ((size_t)vect->dataTypeSize * index),
+		(size_t)vect->dataTypeSize * (vect->numItems - index));
+	memcpy((char*)vect->data + ((size_t)vect->dataTypeSize * index), data, (size_t)vect->dataTypeSize * count);
+
+	vect->numItems += count;
 
 	return true;
 }
@@ -87,12 +423,8 @@ bool VectorInsert(const void* data, int index, Vector* vect)
 	if (index == vect->numItems)
 		return VectorAdd(data, vect);
 
-	if (vect->currentCapacity < vect->numItems + 1)
-	{
-		// Need to increase the capacity of the vector. Since initial capacity can be a zero, take that into account.
-		vect->currentCapacity += (vect->currentCapacity > 0 ? vect->currentCapacity : 1) * 2;
-		vect->data = realloc(vect->data, vect->currentCapacity * vect->dataTypeSize);
-	}
+	if (!VectorGrow(vect->numItems + 1, vect))
+		return false;
 
 	// Shift the proper subset of elements (elements to the right of the insertion index) 1 to the right.
 	memmove(
@@ -186,6 +518,45 @@ void* VectorRemoveSafe(int index, Vector* vect)
 	return savedData;
 }
 
+bool VectorRemoveRange(int index, unsigned int count, Vector* vect)
+{
+	// The whole range to remove needs to be valid.
+	if (index < 0 || index > vect->numItems || count > vect->numItems - index)
+		return false;
+
+	// Shift the items after the range down over it, once.
+	memmove(
+		(char*)vect->data + ((size_t)vect->dataTypeSize * index),
+		(char*)vect->data + ((size_t)vect->dataTypeSize * (index + count)),
+		(size_t)vect->dataTypeSize * (vect->numItems - index - count));
+
+	vect->numItems -= count;
+
+	return true;
+}
+
+unsigned int VectorRemoveIf(PredicateFunction* predicate, void* context, Vector* vect)
+{
+	// Walk the vector once, moving each item that is kept down into the next free place. Items before the first one
+	// removed never move.
+	size_t size = vect->dataTypeSize;
+	char* items = vect->data;
+	unsigned int kept = 0;
+	for (unsigned int i = 0; i < vect->numItems; i++)
+	{
+		char* item = items + size * i;
+		if (predicate(item, context))
+			continue;
+		if (kept != i)
+			memcpy(items + size * kept, item, size);
+		kept++;
+	}
+
+	unsigned int removed = vect->numItems - kept;
+	vect->numItems = kept;
+	return removed;
+}
+
 int VectorIndexOf(const void* data, Vector* vect)
 {
 	// The equals function must be set to use the IndexOf method.
@@ -207,6 +578,57 @@ bool VectorContains(const void* data, Vector* vect)
 	return VectorIndexOf(data, vect) != -1;
 }
 
+// Finds the first item that the compare function does not put before data, or after data too if orEqual is set. The
+// search halves the range each step by moving the base up or not, which compiles to a conditional move rather than a
+// branch the processor would mispredict half the time.
+static unsigned int VectorBound(const void* data, bool orEqual, Vector* vect)
+{
+	// Make sure the compare function is defined.
+	assert(vect->compareFunction != NULL);
+
+	unsigned int length = vect->numItems;
+	if (length == 0)
+		return 0;
+
+	size_t size = vect->dataTypeSize;
+	const char* base = vect->data;
+	int limit = orEqual ? 1 : 0;
+	while (length > 1)
+	{
+		unsigned int half = length / 2;
+		base = vect->compareFunction(base + size * half, data) < limit ? base + size * half : base;
+		length -= half;
+	}
+
+	return (unsigned int)((base - (const char*)vect->data) / size) + (vect->compareFunction(base, data) < limit);
+}
+
+unsigned int VectorLowerBound(const void* data, Vector* vect)
+{
+	return VectorBound(data, false, vect);
+}
+
+unsigned int VectorUpperBound(const void* data, Vector* vect)
+{
+	return VectorBound(data, true, vect);
+}
+
+int VectorBinarySearch(const void* data, Vector* vect)
+{
+	unsigned int index = VectorBound(data, false, vect);
+	if (index < vect->numItems && vect->compareFunction(VectorGet(index, vect), data) == 0)
+		return (int)index;
+
+	// The item was not found.
+	return -1;
+}
+
+bool VectorInsertSorted(const void* data, Vector* vect)
+{
+	// Insert after any equal items, so that equal items stay in the order they were inserted in.
+	return VectorInsert(data, (int)VectorBound(data, true, vect), vect);
+}
+
 unsigned int VectorCount(Vector* vect)
 {
 	return vect->numItems;
@@ -240,19 +662,12 @@ bool VectorCopy(Vector* vectOther, Vector* vect)
 		return false;
 
 	// The first thing to do is ensure vectOther has enough space to take in the contents of this
-	// vector.
+	// vector. Is it allowed to expand that far?
 	unsigned int resultSize = vectOther->numItems + vect->numItems;
-	if (vectOther->currentCapacity < resultSize)
-	{
-		// vectOther needs to have its space expanded. Is it allowed to do this?
-		if (vectOther->maxCapacity > 0 && vectOther->maxCapacity < resultSize)
-			return false;
-
-		// vectOther can have its space expanded. Expand it to double however many items are to be
-		// added to it, plus its previous capacity.
-		vectOther->currentCapacity += resultSize * 2;
-		vectOther->data = realloc(vectOther->data, vectOther->dataTypeSize * resultSize);
-	}
+	if (vectOther->maxCapacity > 0 && vectOther->maxCapacity < resultSize)
+		return false;
+	if (!VectorGrow(resultSize, vectOther))
+		return false;
 
 	// Copy the entirety of the vector into the proper position of vectOther.
 	memcpy((char*)vectOther->data + (vectOther->dataTypeSize * vectOther->numItems), vect->data, vect->numItems * vect->dataTypeSize);
@@ -263,52 +678,145 @@ bool VectorCopy(Vector* vectOther, Vector* vect)
 	return true;
 }
 
-void QSSwap(Vector *vect, int index1, int index2)
+// Items are swapped through a buffer of this many bytes, a piece at a time, so sorting never allocates to swap.
+#define SORT_SWAP_BUFFER_SIZE 64
+
+// Ranges of this many items or fewer are insertion sorted, which is quicker than partitioning them any further.
+#define SORT_INSERTION_THRESHOLD 16
+
+// Gets the item at the specified index, without checking the bounds.
+static inline char* SortItem(Vector* vect, unsigned int index)
 {
-	if (index1 == index2)
-		return;
+	return (char*)vect->data + (size_t)vect->dataTypeSize * index;
+}
 
-	// Copy the value at index 1 to temp.
-	void* temp = malloc(vect->dataTypeSize);
-	memcpy(temp, vect->data + (vect->dataTypeSize * index1), vect->dataTypeSize);
+// Swaps two items of the given size.
+static void SortSwap(char* item1, char* item2, unsigned int size)
+{
+	char buffer[SORT_SWAP_BUFFER_SIZE];
+	while (size > 0)
+	{
+		unsigned int part = size < SORT_SWAP_BUFFER_SIZE ? size : SORT_SWAP_BUFFER_SIZE;
+		memcpy(buffer, item1, part);
+		memcpy(item1, item2, part);
+		memcpy(item2, buffer, part);
+		item1 += part;
+		item2 += part;
+		size -= part;
+	}
+}
 
-	// Overwrite the value at index 1 with the value in index 2.
-	memmove(vect->data + (vect->dataTypeSize * index1), vect->data + (vect->dataTypeSize * index2), vect->dataTypeSize);
+// Sorts the items from low to high, inclusive, by moving each item down until the one before it is not greater. Equal
+// items are never swapped, so this is stable.
+static void InsertionSort(Vector* vect, unsigned int low, unsigned int high)
+{
+	for (unsigned int i = low + 1; i <= high; i++)
+		for (unsigned int j = i; j > low && vect->compareFunction(SortItem(vect, j - 1), SortItem(vect, j)) > 0; j--)
+			SortSwap(SortItem(vect, j - 1), SortItem(vect, j), vect->dataTypeSize);
+}
 
-	// Complete the swap by copying the temp value back into the data array.
-	memcpy(vect->data + (vect->dataTypeSize * index2), temp, vect->dataTypeSize);
+// Moves the item at root, an index relative to low, down the heap of count items until it is not less than its
+// children.
+static void HeapSiftDown(Vector* vect, unsigned int low, unsigned int root, unsigned int count)
+{
+	for (;;)
+	{
+		unsigned int child = 2 * root + 1;
+		if (child >= count)
+			return;
+		if (child + 1 < count && vect->compareFunction(SortItem(vect, low + child), SortItem(vect, low + child + 1)) < 0)
+			child++;
+		if (vect->compareFunction(SortItem(vect, low + root), SortItem(vect, low + child)) >= 0)
+			return;
+		SortSwap(SortItem(vect, low + root), SortItem(vect, low + child), vect->dataTypeSize);
+		root = child;
+	}
+}
 
-	// Free the temp value.
-	free(temp);
+// Sorts the items from low to high, inclusive, in O(n log n) whatever their order.
+static void HeapSort(Vector* vect, unsigned int low, unsigned int high)
+{
+	unsigned int count = high - low + 1;
+	for (unsigned int root = count / 2; root-- > 0;)
+		HeapSiftDown(vect, low, root, count);
+	for (unsigned int end = count - 1; end > 0; end--)
+	{
+		SortSwap(SortItem(vect, low), SortItem(vect, low + end), vect->dataTypeSize);
+		HeapSiftDown(vect, low, 0, end);
+	}
 }
 
-int QSPartition(Vector* vect, int lowIndex, int highIndex)
+// Partitions the items from low to high, inclusive, around the median of the first, middle and last items, and
+// returns the index the pivot ends up at. Scanning stops on items equal to the pivot, so runs of equal items still
+// split evenly.
+static unsigned int SortPartition(Vector* vect, unsigned int low, unsigned int high)
 {
-    void* pivotValue = VectorGet(highIndex, vect);
-    int i = (lowIndex - 1);
+	CompareToFunction* compare = vect->compareFunction;
+	unsigned int size = vect->dataTypeSize;
 
-    for (int j = lowIndex; j <= highIndex - 1; j++)
-    {
-        if (vect->compareFunction(VectorGet(j, vect), pivotValue) <= 0)
-        {
-            i++;
-            QSSwap(vect, i, j);
-        }
-    }
+	// Order the first, middle and last items, then move the median to the front to be the pivot. The last item is
+	// then no less than the pivot and the pivot itself is at the front, so neither scan below can run off the range.
+	unsigned int middle = low + (high - low) / 2;
+	if (compare(SortItem(vect, middle), SortItem(vect, low)) < 0)
+		SortSwap(SortItem(vect, middle), SortItem(vect, low), size);
+	if (compare(SortItem(vect, high), SortItem(vect, middle)) < 0)
+	{
+		SortSwap(SortItem(vect, high), SortItem(vect, middle), size);
+		if (compare(SortItem(vect, middle), SortItem(vect, low)) < 0)
+			SortSwap(SortItem(vect, middle), SortItem(vect, low), size);
+	}
+	SortSwap(SortItem(vect, low), SortItem(vect, middle), size);
 
-    QSSwap(vect, i+1, highIndex);
-    return i + 1;
+	char* pivot = SortItem(vect, low);
+	unsigned int i = low;
+	unsigned int j = high + 1;
+	for (;;)
+	{
+		do
+			i++;
+		while (compare(SortItem(vect, i), pivot) < 0);
+		do
+			j--;
+		while (compare(SortItem(vect, j), pivot) > 0);
+		if (i >= j)
+			break;
+		SortSwap(SortItem(vect, i), SortItem(vect, j), size);
+	}
+
+	SortSwap(pivot, SortItem(vect, j), size);
+	return j;
 }
 
-void QuickSort(Vector* vect, int low, int high)
+// Sorts the items from low to high, inclusive. This is a quicksort that insertion sorts small ranges, and that switches
+// to a heap sort once it has partitioned too many times, so bad pivots can never make it quadratic.
+static void IntroSort(Vector* vect, unsigned int low, unsigned int high, unsigned int depthLimit)
 {
-	// Only have to sort if we are sorting more than one number.
-	if (low < high)
+	while (high - low >= SORT_INSERTION_THRESHOLD)
 	{
-        int pivot = QSPartition(vect, low, high);
-        QuickSort(vect, low, pivot - 1);
-        QuickSort(vect, pivot + 1, high);
+		if (depthLimit == 0)
+		{
+			HeapSort(vect, low, high);
+			return;
+		}
+		depthLimit--;
+
+		// Recurse into the smaller side and loop on the larger one, so the stack is never more than O(log n) deep.
+		unsigned int pivot = SortPartition(vect, low, high);
+		if (pivot - low < high - pivot)
+		{
+			if (pivot > low)
+				IntroSort(vect, low, pivot - 1, depthLimit);
+			low = pivot + 1;
+		}
+		else
+		{
+			if (pivot < high)
+				IntroSort(vect, pivot + 1, high, depthLimit);
+			high = pivot - 1;
+		}
 	}
+
+	InsertionSort(vect, low, high);
 }
 
 void VectorSort(Vector* vect)
@@ -316,6 +824,274 @@ void VectorSort(Vector* vect)
 	// Make sure the compare function is defined.
 	assert(vect->compareFunction != NULL);
 
-	// Call QuickSort to sort the values in the vector.
-	QuickSort(vect, 0, vect->numItems - 1);
-}
\ No newline at end of file
+	if (vect->numItems < 2)
+		return;
+
+	// Vectors are often sorted already, or sorted backwards, so check for those first, which only takes one pass.
+	unsigned int i = 1;
+	while (i < vect->numItems && vect->compareFunction(SortItem(vect, i - 1), SortItem(vect, i)) <= 0)
+		i++;
+	if (i == vect->numItems)
+		return;
+
+	i = 1;
+	while (i < vect->numItems && vect->compareFunction(SortItem(vect, i - 1), SortItem(vect, i)) > 0)
+		i++;
+	if (i == vect->numItems)
+	{
+		for (unsigned int low = 0, high = vect->numItems - 1; low < high; low++, high--)
+			SortSwap(SortItem(vect, low), SortItem(vect, high), vect->dataTypeSize);
+		return;
+	}
+
+	// Allow twice as many partitions as a perfectly balanced quicksort would need before falling back to a heap sort.
+	unsigned int depthLimit = 0;
+	for (unsigned int count = vect->numItems; count > 1; count >>= 1)
+		depthLimit += 2;
+
+	IntroSort(vect, 0, vect->numItems - 1, depthLimit);
+}
+
+// Merges the sorted items from low to middle - 1 and from middle to high - 1 of source into target, taking from the
+// first half when items are equal so that the merge is stable.
+static void MergeRuns(Vector* vect, const char* source, char* target, unsigned int low, unsigned int middle,
+					  unsigned int high)
+{
+	size_t size = vect->dataTypeSize;
+	unsigned int left = low;
+	unsigned int right = middle;
+	for (unsigned int i = low; i < high; i++)
+	{
+		if (right >= high || (left < middle && vect->compareFunction(source + left * size, source + right * size) <= 0))
+			memcpy(target + i * size, source + left++ * size, size);
+		else
+			memcpy(target + i * size, source + right++ * size, size);
+	}
+}
+
+bool VectorStableSort(Vector* vect)
+{
+	// Make sure the compare function is defined.
+	assert(vect->compareFunction != NULL);
+
+	unsigned int count = vect->numItems;
+	if (count < 2)
+		return true;
+
+	// The buffer is as big as the vector's storage, so that if the sorted items end up in it, it can just replace the
+	// vector's data.
+	char* buffer = AllocatorAllocate((size_t)vect->currentCapacity * vect->dataTypeSize, &vect->allocator);
+	if (buffer == NULL)
+		return false;
+
+	// Insertion sort short runs, then merge runs pairwise, back and forth between the data and the buffer, doubling
+	// their length each pass.
+	for (unsigned int low = 0; low < count; low += SORT_INSERTION_THRESHOLD)
+		InsertionSort(vect, low, (count - low > SORT_INSERTION_THRESHOLD ? low + SORT_INSERTION_THRESHOLD : count) - 1);
+
+	char* source = vect->data;
+	char* target = buffer;
+	for (unsigned int width = SORT_INSERTION_THRESHOLD; width < count; width *= 2)
+	{
+		for (unsigned int low = 0; low < count; low += 2 * width)
+		{
+			unsigned int middle = count - low > width ? low + width : count;
+			unsigned int high = count - middle > width ? middle + width : count;
+			MergeRuns(vect, source, target, low, middle, high);
+		}
+
+		char* merged = target;
+		target = source;
+		source = merged;
+	}
+
+	// The sorted items are in source, and the other block is no longer needed.
+	if (source == vect->data)
+		AllocatorRelease(target, (size_t)vect->currentCapacity * vect->dataTypeSize, &vect->allocator);
+	else
+		VectorTakeData(source, vect);
+
+	return true;
+}
+
+// An item's key and where the item was, which a radix sort moves around in place of the item itself.
+typedef struct tagSortKey
+{
+	unsigned long long key;
+	unsigned int index;
+} SortKey;
+
+bool VectorSortByKey(SortKeyFunction* keyFunction, Vector* vect)
+{
+	unsigned int count = vect->numItems;
+	if (count < 2)
+		return true;
+
+	size_t keysSize = 2 * (size_t)count * sizeof(SortKey);
+	SortKey* keys = AllocatorAllocate(keysSize, &vect->allocator);
+	if (keys == NULL)
+		return false;
+
+	// Extract every key and count the digits of every byte of them in one pass.
+	static const unsigned int digitBits = 8;
+	static const unsigned int numDigits = sizeof(unsigned long long);
+	unsigned int digitCounts[sizeof(unsigned long long)][256] = { { 0 } };
+	bool alreadySorted = true;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		keys[i].key = keyFunction(SortItem(vect, i));
+		keys[i].index = i;
+		alreadySorted = alreadySorted && (i == 0 || keys[i - 1].key <= keys[i].key);
+		for (unsigned int digit = 0; digit < numDigits; digit++)
+			digitCounts[digit][(keys[i].key >> (digit * digitBits)) & 0xFF]++;
+	}
+	if (alreadySorted)
+	{
+		AllocatorRelease(keys, keysSize, &vect->allocator);
+		return true;
+	}
+
+	char* sorted = AllocatorAllocate((size_t)vect->currentCapacity * vect->dataTypeSize, &vect->allocator);
+	if (sorted == NULL)
+	{
+		AllocatorRelease(keys, keysSize, &vect->allocator);
+		return false;
+	}
+
+	// Sort the keys a byte at a time, from the least significant, skipping bytes that every key has the same value
+	// in. Each pass keeps the order of the last, so the sort is stable.
+	SortKey* source = keys;
+	SortKey* target = keys + count;
+	for (unsigned int digit = 0; digit < numDigits; digit++)
+	{
+		unsigned int* counts = digitCounts[digit];
+		unsigned int shift = digit * digitBits;
+		if (counts[(source[0].key >> shift) & 0xFF] == count)
+			continue;
+
+		unsigned int offsets[256];
+		unsigned int offset = 0;
+		for (unsigned int value = 0; value < 256; value++)
+		{
+			offsets[value] = offset;
+			offset += counts[value];
+		}
+		for (unsigned int i = 0; i < count; i++)
+			target[offsets[(source[i].key >> shift) & 0xFF]++] = source[i];
+
+		SortKey* passed = target;
+		target = source;
+		source = passed;
+	}
+
+	// Move the items themselves just once, into their sorted order.
+	for (unsigned int i = 0; i < count; i++)
+		memcpy(sorted + (size_t)vect->dataTypeSize * i, SortItem(vect, source[i].index), vect->dataTypeSize);
+
+	VectorTakeData(sorted, vect);
+	AllocatorRelease(keys, keysSize, &vect->allocator);
+
+	return true;
+}
+
+// The fewest items a chunk of a parallel operation gets, so that the cost of handing out chunks stays small next to the
+// work in them.
+#define PARALLEL_MIN_CHUNK_ITEMS 1024
+
+// The state a parallel operation shares with every chunk of it.
+typedef struct tagParallelJob
+{
+	Vector* vect;
+	void* context;
+	ForEachFunction* forEach;
+	MapFunction* map;
+	Vector* destination;
+	ReduceFunction* accumulate;
+	unsigned int resultSize;
+	// The result of every chunk of a reduce, one after another.
+	char* chunkResults;
+} ParallelJob;
+
+static void ParallelForEachChunk(unsigned int chunk, unsigned int start, unsigned int end, void* context)
+{
+	(void)chunk;
+	ParallelJob* job = context;
+	for (unsigned int i = start; i < end; i++)
+		job->forEach(SortItem(job->vect, i), job->context);
+}
+
+void VectorParallelForEach(ForEachFunction* function, void* context, ThreadPool* pool, Vector* vect)
+{
+	ParallelJob job = { 0 };
+	job.vect = vect;
+	job.context = context;
+	job.forEach = function;
+	ThreadPoolRun(vect->numItems, PARALLEL_MIN_CHUNK_ITEMS, ParallelForEachChunk, &job, pool);
+}
+
+static void ParallelMapChunk(unsigned int chunk, unsigned int start, unsigned int end, void* context)
+{
+	(void)chunk;
+	ParallelJob* job = context;
+	for (unsigned int i = start; i < end; i++)
+		job->map(SortItem(job->vect, i), SortItem(job->destination, i), job->context);
+}
+
+bool VectorParallelMap(MapFunction* function, void* context, Vector* destination, ThreadPool* pool, Vector* vect)
+{
+	// Every result has its own place in the destination before any chunk starts, so the chunks never make it grow.
+	if (destination == vect || !VectorResize(vect->numItems, destination))
+		return false;
+
+	ParallelJob job = { 0 };
+	job.vect = vect;
+	job.context = context;
+	job.map = function;
+	job.destination = destination;
+	ThreadPoolRun(vect->numItems, PARALLEL_MIN_CHUNK_ITEMS, ParallelMapChunk, &job, pool);
+	return true;
+}
+
+static void ParallelReduceChunk(unsigned int chunk, unsigned int start, unsigned int end, void* context)
+{
+	ParallelJob* job = context;
+	char* result = job->chunkResults + (size_t)job->resultSize * chunk;
+	for (unsigned int i = start; i < end; i++)
+		job->accumulate(result, SortItem(job->vect, i), job->context);
+}
+
+bool VectorParallelReduce(ReduceFunction* accumulate, ReduceFunction* combine, unsigned int resultSize, void* result,
+						  void* context, ThreadPool* pool, Vector* vect)
+{
+	unsigned int chunkCount = ThreadPoolCountChunks(vect->numItems, PARALLEL_MIN_CHUNK_ITEMS, pool);
+
+	// A single chunk can fold its items straight into the result.
+	if (chunkCount <= 1)
+	{
+		for (unsigned int i = 0; i < vect->numItems; i++)
+			accumulate(result, SortItem(vect, i), context);
+		return true;
+	}
+
+	ParallelJob job = { 0 };
+	job.vect = vect;
+	job.context = context;
+	job.accumulate = accumulate;
+	job.resultSize = resultSize;
+	job.chunkResults = AllocatorAllocate((size_t)resultSize * chunkCount, &vect->allocator);
+	if (job.chunkResults == NULL)
+		return false;
+
+	// Every chunk starts from the identity the result holds.
+	for (unsigned int chunk = 0; chunk < chunkCount; chunk++)
+		memcpy(job.chunkResults + (size_t)resultSize * chunk, result, resultSize);
+
+	ThreadPoolRun(vect->numItems, PARALLEL_MIN_CHUNK_ITEMS, ParallelReduceChunk, &job, pool);
+
+	// Fold the chunks' results together in the order of their items, which is all an associative combine needs.
+	for (unsigned int chunk = 0; chunk < chunkCount; chunk++)
+		combine(result, job.chunkResults + (size_t)resultSize * chunk, context);
+
+	AllocatorRelease(job.chunkResults, (size_t)resultSize * chunkCount, &vect->allocator);
+	return true;
+}
@@ -0,0 +1,249 @@
+/**
+ * @file ThreadPoolTest.c
+ */
+
+#include <CLib/CLibraryExtensions.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+// The tests are made of asserts, so they have to stay in even when building for release.
+#undef NDEBUG
+#include <assert.h>
+
+// The biggest number of threads the tests create a pool with.
+#define MAX_TEST_THREADS 5
+
+// The item counts to test with: none, a single chunk's worth, and enough to split into many chunks.
+static const unsigned int TestCounts[] = { 0, 1, 7, 1000, 1024, 5000, 200000 };
+
+static void DoubleItem(void* obj, void* context)
+{
+    (void)context;
+    *(long*)obj *= 2;
+}
+
+static void SquareItem(const void* obj, void* result, void* context)
+{
+    (void)context;
+    long value = *(const long*)obj;
+    *(long long*)result = (long long)value * value;
+}
+
+static void AddItem(void* accumulator, const void* value, void* context)
+{
+    (void)context;
+    *(long long*)accumulator += *(const long*)value;
+}
+
+static void AddSum(void* accumulator, const void* value, void* context)
+{
+    (void)context;
+    *(long long*)accumulator += *(const long long*)value;
+}
+
+// A reduction that is associative but not commutative: the first and last items of a run, and whether every item
+// came right after the one before it. It only comes out right if the chunks are combined in order.
+typedef struct tagRun
+{
+    long first;
+    long last;
+    bool consecutive;
+    bool empty;
+} Run;
+
+static void AddToRun(void* accumulator, const void* value, void* context)
+{
+    (void)context;
+    Run* run = accumulator;
+    long item = *(const long*)value;
+    if (run->empty)
+    {
+        run->first = item;
+        run->empty = false;
+    }
+    else if (item != run->last + 1)
+    {
+        run->consecutive = false;
+    }
+    run->last = item;
+}
+
+static void JoinRuns(void* accumulator, const void* value, void* context)
+{
+    (void)context;
+    Run* run = accumulator;
+    const Run* next = value;
+    if (next->empty)
+        return;
+    if (run->empty)
+    {
+        *run = *next;
+        return;
+    }
+    run->consecutive = run->consecutive && next->consecutive && next->first == run->last + 1;
+    run->last = next->last;
+}
+
+// Creates a vector holding the numbers from 0 up to count.
+static Vector* CreateCountingVector(unsigned int count)
+{
+    Vector* vect;
+    assert(VectorCreate(sizeof(long), count > 0 ? count : 1, 0, NULL, NULL, &vect));
+    for (long i = 0; i < (long)count; i++)
+        assert(VectorAdd(&i, vect));
+    return vect;
+}
+
+// Runs every test count on a pool of the given number of threads, or with no pool at all for 0.
+static void RunWithPools(void (*test)(unsigned int count, ThreadPool* pool))
+{
+    for (unsigned int threads = 0; threads <= MAX_TEST_THREADS; threads++)
+    {
+        ThreadPool* pool = NULL;
+        if (threads > 0)
+        {
+            assert(ThreadPoolCreate(threads, &pool));
+            assert(ThreadPoolCountThreads(pool) == threads);
+        }
+
+        for (unsigned int i = 0; i < sizeof(TestCounts) / sizeof(TestCounts[0]); i++)
+            test(TestCounts[i], pool);
+
+        if (pool != NULL)
+            ThreadPoolDestroy(&pool);
+    }
+}
+
+static void ForEachShouldVisitEveryItemOnce(unsigned int count, ThreadPool* pool)
+{
+    Vector* vect = CreateCountingVector(count);
+    VectorParallelForEach(DoubleItem, NULL, pool, vect);
+    VectorParallelForEach(DoubleItem, NULL, pool, vect);
+    for (unsigned int i = 0; i < count; i++)
+        assert(*(long*)VectorGet(i, vect) == 4 * (long)i);
+    VectorDestroy(&vect);
+}
+
+static void MapShouldWriteEveryResultInPlace(unsigned int count, ThreadPool* pool)
+{
+    Vector* vect = CreateCountingVector(count);
+    Vector* squares;
+    assert(VectorCreate(sizeof(long long), 1, 0, NULL, NULL, &squares));
+
+    assert(VectorParallelMap(SquareItem, NULL, squares, pool, vect));
+    assert(VectorCount(squares) == count);
+    for (unsigned int i = 0; i < count; i++)
+        assert(*(long long*)VectorGet(i, squares) == (long long)i * i);
+
+    // A vector can't be mapped into itself.
+    assert(!VectorParallelMap(SquareItem, NULL, vect, pool, vect));
+
+    VectorDestroy(&squares);
+    VectorDestroy(&vect);
+}
+
+static void ReduceShouldMatchSequentialResult(unsigned int count, ThreadPool* pool)
+{
+    Vector* vect = CreateCountingVector(count);
+
+    long long sum = 0;
+    assert(VectorParallelReduce(AddItem, AddSum, sizeof(sum), &sum, NULL, pool, vect));
+    assert(sum == (long long)count * (count > 0 ? count - 1 : 0) / 2);
+
+    Run run = { 0, 0, true, true };
+    assert(VectorParallelReduce(AddToRun, JoinRuns, sizeof(run), &run, NULL, pool, vect));
+    assert(run.empty == (count == 0));
+    assert(run.consecutive);
+    if (count > 0)
+        assert(run.first == 0 && run.last == (long)count - 1);
+
+    VectorDestroy(&vect);
+}
+
+void VectorParallelForEachShouldVisitEveryItemOnce()
+{
+    RunWithPools(ForEachShouldVisitEveryItemOnce);
+}
+
+void VectorParallelMapShouldWriteEveryResultInPlace()
+{
+    RunWithPools(MapShouldWriteEveryResultInPlace);
+}
+
+void VectorParallelReduceShouldMatchSequentialResult()
+{
+    RunWithPools(ReduceShouldMatchSequentialResult);
+}
+
+// Records how many times each index of a job was visited, and how many chunks ran.
+typedef struct tagChunkRecord
+{
+    unsigned int* covered;
+    unsigned int chunksRun;
+} ChunkRecord;
+
+static void RecordChunk(unsigned int chunk, unsigned int start, unsigned int end, void* context)
+{
+    (void)chunk;
+    ChunkRecord* record = context;
+    for (unsigned int i = start; i < end; i++)
+        __atomic_fetch_add(&record->covered[i], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&record->chunksRun, 1, __ATOMIC_RELAXED);
+}
+
+void ThreadPoolRunShouldCoverEveryIndexOnce()
+{
+    ThreadPool* pool;
+    assert(ThreadPoolCreate(4, &pool));
+
+    for (unsigned int i = 0; i < sizeof(TestCounts) / sizeof(TestCounts[0]); i++)
+    {
+        unsigned int count = TestCounts[i];
+        ChunkRecord record = { calloc(count > 0 ? count : 1, sizeof(unsigned int)), 0 };
+
+        ThreadPoolRun(count, 100, RecordChunk, &record, pool);
+        assert(record.chunksRun == ThreadPoolCountChunks(count, 100, pool));
+        for (unsigned int j = 0; j < count; j++)
+            assert(record.covered[j] == 1);
+
+        free(record.covered);
+    }
+
+    ThreadPoolDestroy(&pool);
+}
+
+void ThreadPoolShouldRunSmallJobsAsOneChunk()
+{
+    ThreadPool* pool;
+    assert(ThreadPoolCreate(4, &pool));
+
+    // No indices means no chunks, and fewer indices than the minimum chunk size means one.
+    assert(ThreadPoolCountChunks(0, 100, pool) == 0);
+    assert(ThreadPoolCountChunks(99, 100, pool) == 1);
+    assert(ThreadPoolCountChunks(100000, 100, pool) > 1);
+
+    // Without a pool, or with a pool of one thread, there is only ever one chunk.
+    assert(ThreadPoolCountThreads(NULL) == 1);
+    assert(ThreadPoolCountChunks(100000, 100, NULL) == 1);
+    ThreadPool* single;
+    assert(ThreadPoolCreate(1, &single));
+    assert(ThreadPoolCountChunks(100000, 100, single) == 1);
+    ThreadPoolDestroy(&single);
+
+    ThreadPoolDestroy(&pool);
+}
+
+int main()
+{
+    printf("Running Thread Pool tests.\n");
+
+    // Execute all tests.
+    ThreadPoolRunShouldCoverEveryIndexOnce();
+    ThreadPoolShouldRunSmallJobsAsOneChunk();
+    VectorParallelForEachShouldVisitEveryItemOnce();
+    VectorParallelMapShouldWriteEveryResultInPlace();
+    VectorParallelReduceShouldMatchSequentialResult();
+
+    printf("All Thread Pool tests passed.\n");
+    return 0;
+}
@@ -0,0 +1,288 @@
+/**
+ * @file TimingWheelTest.c
+ */
+
+#include <CLib/CLibraryExtensions.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+
+// The tests are made of asserts, so they have to stay in even when building for release.
+#undef NDEBUG
+#include <assert.h>
+
+// The number of timers the randomized tests keep in the wheel at once.
+#define RANDOM_TIMER_COUNT 5000
+
+// A timer as the tests expect it to be: the order it was scheduled in breaks ties between equal expiry times.
+typedef struct tagExpectedTimer
+{
+    unsigned int expiryTime;
+    int sequence;
+    TimerHandle handle;
+    bool live;
+} ExpectedTimer;
+
+static int ExpectedTimerCompareTo(const void* obj1, const void* obj2)
+{
+    const ExpectedTimer* timer1 = obj1;
+    const ExpectedTimer* timer2 = obj2;
+    if (timer1->expiryTime != timer2->expiryTime)
+        return timer1->expiryTime < timer2->expiryTime ? -1 : 1;
+    return timer1->sequence - timer2->sequence;
+}
+
+// Advances the wheel to the given time, and checks that exactly the live timers due by then pop out, in order of
+// expiry time and then of scheduling.
+static void AdvanceAndCheck(unsigned int time, ExpectedTimer* timers, int count, TimingWheel* wheel)
+{
+    TimingWheelAdvance(time, wheel);
+    assert(TimingWheelCurrentTime(wheel) == time);
+
+    ExpectedTimer* due = malloc(sizeof(ExpectedTimer) * (count > 0 ? count : 1));
+    int dueCount = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (timers[i].live && timers[i].expiryTime <= time)
+        {
+            due[dueCount++] = timers[i];
+            timers[i].live = false;
+        }
+    }
+    qsort(due, dueCount, sizeof(ExpectedTimer), ExpectedTimerCompareTo);
+
+    for (int i = 0; i < dueCount; i++)
+    {
+        int sequence;
+        unsigned int expiryTime;
+        assert(TimingWheelPopExpired(&sequence, &expiryTime, wheel));
+        assert(sequence == due[i].sequence);
+        assert(expiryTime == due[i].expiryTime);
+    }
+    assert(!TimingWheelPopExpired(NULL, NULL, wheel));
+    free(due);
+}
+
+void TimingWheelShouldExpireTimersInOrderOfExpiryAndScheduling()
+{
+    srand(1);
+    TimingWheel* wheel;
+    assert(TimingWheelCreate(sizeof(int), 0, &wheel));
+
+    // Several timers share each expiry time, so ties have to come out in the order they were scheduled.
+    ExpectedTimer timers[RANDOM_TIMER_COUNT];
+    for (int i = 0; i < RANDOM_TIMER_COUNT; i++)
+    {
+        timers[i].expiryTime = 1 + rand() % 1000;
+        timers[i].sequence = i;
+        timers[i].live = true;
+        assert(TimingWheelSchedule(&i, timers[i].expiryTime, &timers[i].handle, wheel));
+    }
+    assert(TimingWheelCount(wheel) == RANDOM_TIMER_COUNT);
+
+    for (unsigned int time = 0; time <= 1000; time += 1 + rand() % 37)
+        AdvanceAndCheck(time, timers, RANDOM_TIMER_COUNT, wheel);
+    AdvanceAndCheck(1000, timers, RANDOM_TIMER_COUNT, wheel);
+
+    assert(TimingWheelIsEmpty(wheel));
+    TimingWheelDestroy(&wheel);
+}
+
+void TimingWheelShouldCascadeTimersFromEveryLevel()
+{
+    srand(2);
+    TimingWheel* wheel;
+    unsigned int startTime = 12345;
+    assert(TimingWheelCreate(sizeof(int), startTime, &wheel));
+
+    // Spread the timers from a tick away to billions of ticks away, so they start out on every level of the wheel,
+    // and advance in uneven steps so cascades happen part way through rotations.
+    ExpectedTimer timers[RANDOM_TIMER_COUNT];
+    for (int i = 0; i < RANDOM_TIMER_COUNT; i++)
+    {
+        unsigned int range = 1u << (rand() % 31);
+        timers[i].expiryTime = startTime + 1 + (unsigned int)rand() % range;
+        timers[i].sequence = i;
+        timers[i].live = true;
+        assert(TimingWheelSchedule(&i, timers[i].expiryTime, &timers[i].handle, wheel));
+    }
+
+    unsigned int time = startTime;
+    while (!TimingWheelIsEmpty(wheel))
+    {
+        // The next expiry the wheel reports must be the earliest live timer.
+        unsigned int nextExpiry;
+        assert(TimingWheelNextExpiry(&nextExpiry, wheel));
+        unsigned int earliest = UINT32_MAX;
+        for (int i = 0; i < RANDOM_TIMER_COUNT; i++)
+            if (timers[i].live && timers[i].expiryTime < earliest)
+                earliest = timers[i].expiryTime;
+        assert(nextExpiry == earliest);
+
+        // Step either straight to the next expiry or some way past it.
+        time = nextExpiry + (rand() % 2 == 0 ? 0 : (unsigned int)rand() % (1u << (rand() % 24)));
+        if (time < nextExpiry)
+            time = UINT32_MAX;
+        AdvanceAndCheck(time, timers, RANDOM_TIMER_COUNT, wheel);
+    }
+
+    TimingWheelDestroy(&wheel);
+}
+
+void TimingWheelShouldNotExpireCancelledTimers()
+{
+    srand(3);
+    TimingWheel* wheel;
+    assert(TimingWheelCreate(sizeof(int), 0, &wheel));
+
+    ExpectedTimer timers[RANDOM_TIMER_COUNT];
+    int liveCount = RANDOM_TIMER_COUNT;
+    for (int i = 0; i < RANDOM_TIMER_COUNT; i++)
+    {
+        timers[i].expiryTime = 1 + (unsigned int)rand() % 100000;
+        timers[i].sequence = i;
+        timers[i].live = true;
+        assert(TimingWheelSchedule(&i, timers[i].expiryTime, &timers[i].handle, wheel));
+    }
+
+    // Cancel every third timer. A cancelled handle can't be cancelled again.
+    for (int i = 0; i < RANDOM_TIMER_COUNT; i += 3)
+    {
+        assert(TimingWheelCancel(timers[i].handle, wheel));
+        assert(!TimingWheelCancel(timers[i].handle, wheel));
+        timers[i].live = false;
+        liveCount--;
+    }
+    assert(TimingWheelCount(wheel) == liveCount);
+
+    // Cancel more timers between advances, after some of the wheel has already been cascaded.
+    for (unsigned int time = 0; time < 100000; time += 1 + (unsigned int)rand() % 5000)
+    {
+        AdvanceAndCheck(time, timers, RANDOM_TIMER_COUNT, wheel);
+        int victim = rand() % RANDOM_TIMER_COUNT;
+        if (timers[victim].live)
+        {
+            assert(TimingWheelCancel(timers[victim].handle, wheel));
+            timers[victim].live = false;
+        }
+    }
+    AdvanceAndCheck(100000, timers, RANDOM_TIMER_COUNT, wheel);
+
+    assert(TimingWheelIsEmpty(wheel));
+    TimingWheelDestroy(&wheel);
+}
+
+void TimingWheelShouldExpireTimersThatAreAlreadyDue()
+{
+    TimingWheel* wheel;
+    assert(TimingWheelCreate(sizeof(int), 100, &wheel));
+
+    int value = 7;
+    assert(TimingWheelSchedule(&value, 50, NULL, wheel));
+    assert(TimingWheelSchedule(&value, 100, NULL, wheel));
+
+    unsigned int expiryTime;
+    assert(TimingWheelPopExpired(&value, &expiryTime, wheel) && expiryTime == 50);
+    assert(TimingWheelPopExpired(&value, &expiryTime, wheel) && expiryTime == 100);
+    assert(!TimingWheelPopExpired(&value, &expiryTime, wheel));
+
+    TimingWheelDestroy(&wheel);
+}
+
+// The state of an allocator that fails when told to, and checks that memory is always released or resized with the
+// size it was allocated with.
+typedef struct tagCheckedAllocator
+{
+    void* memory[16];
+    size_t sizes[16];
+    int failAfter;
+} CheckedAllocator;
+
+static int CheckedAllocatorFind(void* memory, CheckedAllocator* checked)
+{
+    for (int i = 0; i < 16; i++)
+        if (checked->memory[i] == memory)
+            return i;
+    assert(false);
+    return -1;
+}
+
+static void* CheckedAllocate(size_t size, void* context)
+{
+    CheckedAllocator* checked = context;
+    if (checked->failAfter-- == 0)
+        return NULL;
+    int index = CheckedAllocatorFind(NULL, checked);
+    checked->memory[index] = malloc(size);
+    checked->sizes[index] = size;
+    return checked->memory[index];
+}
+
+static void* CheckedReallocate(void* memory, size_t oldSize, size_t newSize, void* context)
+{
+    CheckedAllocator* checked = context;
+    if (checked->failAfter-- == 0)
+        return NULL;
+    int index = CheckedAllocatorFind(memory, checked);
+    assert(checked->sizes[index] == oldSize);
+    checked->memory[index] = realloc(memory, newSize);
+    checked->sizes[index] = newSize;
+    return checked->memory[index];
+}
+
+static void CheckedRelease(void* memory, size_t size, void* context)
+{
+    CheckedAllocator* checked = context;
+    int index = CheckedAllocatorFind(memory, checked);
+    assert(checked->sizes[index] == size);
+    checked->memory[index] = NULL;
+    free(memory);
+}
+
+void TimingWheelShouldKeepItsSizesRightWhenGrowingFails()
+{
+    // Let the wheel and its two arrays be allocated, and fail one of the allocations after that, so growing fails
+    // both before and after the first array has grown.
+    for (int failAfter = 3; failAfter < 8; failAfter++)
+    {
+        CheckedAllocator checked = { { NULL }, { 0 }, failAfter };
+        Allocator allocator = { CheckedAllocate, CheckedReallocate, CheckedRelease, &checked };
+        TimingWheel* wheel;
+        assert(TimingWheelCreateWithAllocator(sizeof(int), 0, &allocator, &wheel));
+
+        int scheduled = 0;
+        for (int i = 0; i < 1000; i++)
+            if (TimingWheelSchedule(&i, 1 + i, NULL, wheel))
+                scheduled++;
+        // Only the one allocation fails, and the wheel grows fine when the next timer is scheduled.
+        assert(scheduled == 999);
+        assert(TimingWheelCount(wheel) == scheduled);
+
+        // Every timer that was scheduled still expires, carrying its own data.
+        TimingWheelAdvance(1000, wheel);
+        int value, popped = 0;
+        while (TimingWheelPopExpired(&value, NULL, wheel))
+            popped++;
+        assert(popped == scheduled);
+
+        // Destroying the wheel checks the sizes it releases its arrays with.
+        TimingWheelDestroy(&wheel);
+        for (int i = 0; i < 16; i++)
+            assert(checked.memory[i] == NULL);
+    }
+}
+
+int main()
+{
+    printf("Running Timing Wheel tests.\n");
+
+    // Execute all tests.
+    TimingWheelShouldExpireTimersInOrderOfExpiryAndScheduling();
+    TimingWheelShouldCascadeTimersFromEveryLevel();
+    TimingWheelShouldNotExpireCancelledTimers();
+    TimingWheelShouldExpireTimersThatAreAlreadyDue();
+    TimingWheelShouldKeepItsSizesRightWhenGrowingFails();
+
+    printf("All Timing Wheel tests passed.\n");
+    return 0;
+}
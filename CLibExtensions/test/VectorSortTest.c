@@ -0,0 +1,212 @@
+/**
+ * @file VectorSortTest.c
+ */
+
+#include <CLib/CLibraryExtensions.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+// The tests are made of asserts, so they have to stay in even when building for release.
+#undef NDEBUG
+#include <assert.h>
+
+// An item to sort: the key it is sorted by, and the position it started out in, to check that a sort is stable.
+typedef struct tagSortTestItem
+{
+    unsigned long long key;
+    unsigned int position;
+} SortTestItem;
+
+// The ways the keys of a test vector can be laid out.
+typedef enum tagKeyLayout
+{
+    KeysSorted,
+    KeysReversed,
+    KeysEqual,
+    KeysRandom,
+    // Random keys drawn from a handful of values, so there are long runs of equal keys.
+    KeysFewDistinct,
+    // Keys that rise and then fall, which trips up quicksorts that pick a poor pivot.
+    KeysOrganPipe,
+    // Random keys that differ only in their highest byte, so a radix sort skips every other byte.
+    KeysHighByte,
+    KeyLayoutCount
+} KeyLayout;
+
+static int SortTestItemCompareTo(const void* obj1, const void* obj2)
+{
+    const SortTestItem* item1 = obj1;
+    const SortTestItem* item2 = obj2;
+    return item1->key < item2->key ? -1 : item1->key > item2->key ? 1 : 0;
+}
+
+static int IntegerCompareTo(const void* obj1, const void* obj2)
+{
+    int value1 = *(const int*)obj1;
+    int value2 = *(const int*)obj2;
+    return value1 < value2 ? -1 : value1 > value2 ? 1 : 0;
+}
+
+static unsigned long long SortTestItemKey(const void* obj)
+{
+    return ((const SortTestItem*)obj)->key;
+}
+
+static unsigned long long RandomKey()
+{
+    return ((unsigned long long)rand() << 42) ^ ((unsigned long long)rand() << 21) ^ (unsigned long long)rand();
+}
+
+// Creates a vector of count items with keys laid out the given way.
+static Vector* CreateTestVector(unsigned int count, KeyLayout layout)
+{
+    Vector* vect;
+    assert(VectorCreate(sizeof(SortTestItem), count > 0 ? count : 1, 0, NULL, SortTestItemCompareTo, &vect));
+    for (unsigned int i = 0; i < count; i++)
+    {
+        SortTestItem item = { 0, i };
+        switch (layout)
+        {
+            case KeysSorted: item.key = i; break;
+            case KeysReversed: item.key = count - i; break;
+            case KeysEqual: item.key = 42; break;
+            case KeysRandom: item.key = RandomKey(); break;
+            case KeysFewDistinct: item.key = (unsigned long long)(rand() % 4); break;
+            case KeysOrganPipe: item.key = i < count / 2 ? i : count - i; break;
+            case KeysHighByte: item.key = (unsigned long long)(rand() % 256) << 56; break;
+            default: assert(false);
+        }
+        assert(VectorAdd(&item, vect));
+    }
+    return vect;
+}
+
+// Checks that a vector holds the same items as the original, sorted by key, and if stable is true, that items with
+// equal keys are still in the order they started in.
+static void AssertSorted(Vector* sorted, Vector* original, bool stable)
+{
+    unsigned int count = VectorCount(original);
+    assert(VectorCount(sorted) == count);
+
+    // Every item is still there exactly once.
+    bool* seen = calloc(count > 0 ? count : 1, sizeof(bool));
+    for (unsigned int i = 0; i < count; i++)
+    {
+        SortTestItem* item = VectorGet(i, sorted);
+        assert(item->position < count && !seen[item->position]);
+        seen[item->position] = true;
+        assert(item->key == ((SortTestItem*)VectorGet(item->position, original))->key);
+    }
+    free(seen);
+
+    for (unsigned int i = 1; i < count; i++)
+    {
+        SortTestItem* previous = VectorGet(i - 1, sorted);
+        SortTestItem* item = VectorGet(i, sorted);
+        assert(previous->key <= item->key);
+        if (stable && previous->key == item->key)
+            assert(previous->position < item->position);
+    }
+}
+
+// The sizes to test every layout at. The small ones are around the size below which ranges are insertion sorted.
+static const unsigned int TestSizes[] = { 0, 1, 2, 3, 15, 16, 17, 31, 32, 33, 100, 1000, 50000 };
+
+void VectorSortShouldOrderEveryLayoutAndSize()
+{
+    srand(1);
+    for (unsigned int size = 0; size < sizeof(TestSizes) / sizeof(TestSizes[0]); size++)
+    {
+        for (int layout = 0; layout < KeyLayoutCount; layout++)
+        {
+            Vector* original = CreateTestVector(TestSizes[size], (KeyLayout)layout);
+            Vector* sorted = CreateTestVector(0, KeysSorted);
+            assert(VectorCopy(sorted, original));
+
+            VectorSort(sorted);
+            AssertSorted(sorted, original, false);
+
+            VectorDestroy(&sorted);
+            VectorDestroy(&original);
+        }
+    }
+}
+
+void VectorStableSortShouldKeepEqualItemsInOrder()
+{
+    srand(2);
+    for (unsigned int size = 0; size < sizeof(TestSizes) / sizeof(TestSizes[0]); size++)
+    {
+        for (int layout = 0; layout < KeyLayoutCount; layout++)
+        {
+            Vector* original = CreateTestVector(TestSizes[size], (KeyLayout)layout);
+            Vector* sorted = CreateTestVector(0, KeysSorted);
+            assert(VectorCopy(sorted, original));
+
+            assert(VectorStableSort(sorted));
+            AssertSorted(sorted, original, true);
+
+            VectorDestroy(&sorted);
+            VectorDestroy(&original);
+        }
+    }
+}
+
+void VectorSortByKeyShouldKeepEqualItemsInOrder()
+{
+    srand(3);
+    for (unsigned int size = 0; size < sizeof(TestSizes) / sizeof(TestSizes[0]); size++)
+    {
+        for (int layout = 0; layout < KeyLayoutCount; layout++)
+        {
+            Vector* original = CreateTestVector(TestSizes[size], (KeyLayout)layout);
+            Vector* sorted = CreateTestVector(0, KeysSorted);
+            assert(VectorCopy(sorted, original));
+
+            assert(VectorSortByKey(SortTestItemKey, sorted));
+            AssertSorted(sorted, original, true);
+
+            VectorDestroy(&sorted);
+            VectorDestroy(&original);
+        }
+    }
+}
+
+void VectorSortShouldAgreeWithQsort()
+{
+    srand(4);
+    for (int round = 0; round < 200; round++)
+    {
+        unsigned int count = (unsigned int)rand() % 300;
+        int* values = malloc(sizeof(int) * (count > 0 ? count : 1));
+        Vector* vect;
+        assert(VectorCreate(sizeof(int), 1, 0, IntegerEquals, IntegerCompareTo, &vect));
+        for (unsigned int i = 0; i < count; i++)
+        {
+            values[i] = rand() % 50 - 25;
+            assert(VectorAdd(&values[i], vect));
+        }
+
+        qsort(values, count, sizeof(int), IntegerCompareTo);
+        VectorSort(vect);
+        for (unsigned int i = 0; i < count; i++)
+            assert(*(int*)VectorGet(i, vect) == values[i]);
+
+        VectorDestroy(&vect);
+        free(values);
+    }
+}
+
+int main()
+{
+    printf("Running Vector sort tests.\n");
+
+    // Execute all tests.
+    VectorSortShouldOrderEveryLayoutAndSize();
+    VectorStableSortShouldKeepEqualItemsInOrder();
+    VectorSortByKeyShouldKeepEqualItemsInOrder();
+    VectorSortShouldAgreeWithQsort();
+
+    printf("All Vector sort tests passed.\n");
+    return 0;
+}
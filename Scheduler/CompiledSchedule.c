@@ -0,0 +1,396 @@
+/**
+ * @file CompiledSchedule.c
+ */
+
+#define _GNU_SOURCE
+
+#include "CompiledSchedule.h"
+#include "Log.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * The magic bytes at the start of every compiled schedule.
+ */
+#define COMPILED_SCHEDULE_MAGIC "SCHD"
+
+/**
+ * Identifies the layout of compiled schedules. Changing the layout means changing this.
+ */
+#define COMPILED_SCHEDULE_VERSION 1
+
+/**
+ * The command length of a process that has no command.
+ */
+#define COMPILED_SCHEDULE_NO_COMMAND UINT32_MAX
+
+/**
+ * The start of a compiled schedule. The numbers are stored in the byte order of the machine that compiled it; a
+ * compiled schedule from a machine with the other byte order fails the version check and is compiled again.
+ */
+typedef struct tagCompiledScheduleHeader
+{
+    char magic[4];
+    uint32_t version;
+
+    /**
+     * The size, modification time and contents hash of the text file the schedule was compiled from. All zero if it
+     * was not compiled from a file.
+     */
+    uint64_t sourceSize;
+    int64_t sourceModifiedSeconds;
+    int64_t sourceModifiedNanoseconds;
+    uint64_t sourceHash;
+
+    uint32_t schedulerType;
+    uint32_t timeQuantum;
+    uint32_t runLength;
+    uint32_t processCount;
+
+    /**
+     * Where the table of names and commands starts. It runs to the end of the file.
+     */
+    uint64_t stringTableOffset;
+} CompiledScheduleHeader;
+
+/**
+ * A process in a compiled schedule. The records follow the header, sorted by arrival.
+ */
+typedef struct tagCompiledProcess
+{
+    /**
+     * Where the process's name and command are in the string table. Neither is null terminated.
+     */
+    uint64_t nameOffset;
+    uint64_t commandOffset;
+    uint32_t nameLength;
+    uint32_t commandLength;
+
+    uint32_t arrivalTime;
+    uint32_t burstLength;
+} CompiledProcess;
+
+/**
+ * Hashes the contents of a file 8 bytes at a time. This only has to notice that the file changed, not stand up to
+ * anyone crafting a collision, so it is a multiply and shift per word rather than a cryptographic hash, and runs at
+ * memory speed.
+ */
+static uint64_t CompiledScheduleHash(const unsigned char* contents, size_t length)
+{
+    const uint64_t multiplier = 0xFF51AFD7ED558CCDull;
+    uint64_t hash = 0x9E3779B97F4A7C15ull ^ length;
+
+    size_t position = 0;
+    for (; position + 8 <= length; position += 8)
+    {
+        uint64_t word;
+        memcpy(&word, contents + position, sizeof(word));
+        hash = (hash ^ word) * multiplier;
+        hash ^= hash >> 32;
+    }
+
+    uint64_t lastWord = 0;
+    memcpy(&lastWord, contents + position, length - position);
+    hash = (hash ^ lastWord) * multiplier;
+
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/**
+ * Maps a whole file into memory, read-only. An empty file gives no contents and a length of 0.
+ */
+static bool MapWholeFile(const char* fileName, const unsigned char** contents, size_t* length, struct stat* fileStats)
+{
+    int file = open(fileName, O_RDONLY | O_CLOEXEC);
+    if (file == -1)
+        return false;
+
+    if (fstat(file, fileStats) == -1)
+    {
+        close(file);
+        return false;
+    }
+
+    *contents = NULL;
+    *length = (size_t)fileStats->st_size;
+    if (*length > 0)
+    {
+        void* mapping = mmap(NULL, *length, PROT_READ, MAP_PRIVATE | MAP_POPULATE, file, 0);
+        if (mapping == MAP_FAILED)
+        {
+            close(file);
+            return false;
+        }
+        *contents = mapping;
+    }
+
+    close(file);
+    return true;
+}
+
+static void UnmapWholeFile(const unsigned char* contents, size_t length)
+{
+    if (contents != NULL)
+        munmap((void*)contents, length);
+}
+
+/**
+ * Records the size, modification time and contents hash of a text file in a header.
+ */
+static bool DescribeSourceFile(const char* sourceFileName, CompiledScheduleHeader* header)
+{
+    const unsigned char* contents;
+    size_t length;
+    struct stat fileStats;
+    if (!MapWholeFile(sourceFileName, &contents, &length, &fileStats))
+        return false;
+
+    header->sourceSize = (uint64_t)length;
+    header->sourceModifiedSeconds = (int64_t)fileStats.st_mtim.tv_sec;
+    header->sourceModifiedNanoseconds = (int64_t)fileStats.st_mtim.tv_nsec;
+    header->sourceHash = CompiledScheduleHash(contents, length);
+
+    UnmapWholeFile(contents, length);
+    return true;
+}
+
+/**
+ * Checks whether a text file is still the one a compiled schedule was compiled from. The size and modification time
+ * are checked first, since they are cheap, and the contents are only hashed if those match.
+ */
+static bool SourceFileMatches(const char* sourceFileName, const CompiledScheduleHeader* header)
+{
+    struct stat fileStats;
+    if (stat(sourceFileName, &fileStats) == -1 || (uint64_t)fileStats.st_size != header->sourceSize ||
+        (int64_t)fileStats.st_mtim.tv_sec != header->sourceModifiedSeconds ||
+        (int64_t)fileStats.st_mtim.tv_nsec != header->sourceModifiedNanoseconds)
+        return false;
+
+    CompiledScheduleHeader current;
+    return DescribeSourceFile(sourceFileName, &current) && current.sourceSize == header->sourceSize &&
+           current.sourceHash == header->sourceHash;
+}
+
+/**
+ * Writes a compiled schedule, with the source file fields already filled in the header.
+ */
+static bool WriteCompiledSchedule(ScheduleData* fileData, CompiledScheduleHeader* header,
+                                  const char* compiledFileName)
+{
+    unsigned int processCount = VectorCount(fileData->processes);
+
+    memcpy(header->magic, COMPILED_SCHEDULE_MAGIC, sizeof(header->magic));
+    header->version = COMPILED_SCHEDULE_VERSION;
+    header->schedulerType = (uint32_t)fileData->schedulerType;
+    header->timeQuantum = fileData->timeQuantum;
+    header->runLength = fileData->runLength;
+    header->processCount = processCount;
+    header->stringTableOffset = sizeof(CompiledScheduleHeader) + (uint64_t)processCount * sizeof(CompiledProcess);
+
+    // Write to a file of this process's own and rename it into place, so no one ever loads half of it.
+    size_t pathLength = strlen(compiledFileName) + 32;
+    char* temporaryPath = malloc(pathLength);
+    if (temporaryPath == NULL)
+        return false;
+    snprintf(temporaryPath, pathLength, "%s.tmp.%ld", compiledFileName, (long)getpid());
+
+    FILE* file = fopen(temporaryPath, "wb");
+    if (file == NULL)
+    {
+        free(temporaryPath);
+        return false;
+    }
+
+    bool succeeded = fwrite(header, sizeof(*header), 1, file) == 1;
+
+    // The records, with the names and commands laid out one after another in the string table.
+    uint64_t stringOffset = 0;
+    for (unsigned int i = 0; succeeded && i < processCount; i++)
+    {
+        InputProcess* process = VectorGet((int)i, fileData->processes);
+        CompiledProcess record = { 0 };
+        record.arrivalTime = process->arrivalTime;
+        record.burstLength = process->burstLength;
+        record.nameOffset = stringOffset;
+        record.nameLength = (uint32_t)strlen(process->processName);
+        stringOffset += record.nameLength;
+
+        record.commandLength = COMPILED_SCHEDULE_NO_COMMAND;
+        if (process->command != NULL)
+        {
+            record.commandOffset = stringOffset;
+            record.commandLength = (uint32_t)strlen(process->command);
+            stringOffset += record.commandLength;
+        }
+
+        succeeded = fwrite(&record, sizeof(record), 1, file) == 1;
+    }
+
+    // The string table.
+    for (unsigned int i = 0; succeeded && i < processCount; i++)
+    {
+        InputProcess* process = VectorGet((int)i, fileData->processes);
+        size_t nameLength = strlen(process->processName);
+        succeeded = fwrite(process->processName, 1, nameLength, file) == nameLength;
+        if (succeeded && process->command != NULL)
+        {
+            size_t commandLength = strlen(process->command);
+            succeeded = fwrite(process->command, 1, commandLength, file) == commandLength;
+        }
+    }
+
+    succeeded = (fclose(file) == 0) && succeeded;
+    succeeded = succeeded && rename(temporaryPath, compiledFileName) == 0;
+    if (!succeeded)
+        remove(temporaryPath);
+
+    free(temporaryPath);
+    return succeeded;
+}
+
+bool CompileSchedule(ScheduleData* fileData, const char* sourceFileName, const char* compiledFileName)
+{
+    CompiledScheduleHeader header = { 0 };
+    if (sourceFileName != NULL && !DescribeSourceFile(sourceFileName, &header))
+    {
+        fprintf(stderr, "Failed to read '%s'.\n", sourceFileName);
+        return false;
+    }
+
+    if (!WriteCompiledSchedule(fileData, &header, compiledFileName))
+    {
+        fprintf(stderr, "Failed to write the compiled schedule '%s'.\n", compiledFileName);
+        return false;
+    }
+
+    return true;
+}
+
+// Reports a problem with a compiled schedule, unless it is only being checked as a cache.
+#define REPORT_LOAD_ERROR(...) do { if (reportErrors) fprintf(stderr, __VA_ARGS__); } while (0)
+
+bool LoadCompiledSchedule(const char* compiledFileName, const char* sourceFileName, ScheduleData* fileData)
+{
+    bool reportErrors = sourceFileName == NULL;
+    fileData->processes = NULL;
+
+    const unsigned char* contents;
+    size_t length;
+    struct stat fileStats;
+    if (!MapWholeFile(compiledFileName, &contents, &length, &fileStats))
+    {
+        REPORT_LOAD_ERROR("Failed to open the compiled schedule '%s'.\n", compiledFileName);
+        return false;
+    }
+
+    // Check the header, and that the records fit in the file.
+    CompiledScheduleHeader header;
+    bool loaded = length >= sizeof(header);
+    if (loaded)
+    {
+        memcpy(&header, contents, sizeof(header));
+        loaded = memcmp(header.magic, COMPILED_SCHEDULE_MAGIC, sizeof(header.magic)) == 0 &&
+                 header.version == COMPILED_SCHEDULE_VERSION && header.schedulerType <= RoundRobin &&
+                 header.stringTableOffset ==
+                     sizeof(header) + (uint64_t)header.processCount * sizeof(CompiledProcess) &&
+                 header.stringTableOffset <= length;
+    }
+    if (!loaded)
+    {
+        REPORT_LOAD_ERROR("'%s' is not a compiled schedule, or was compiled by another version.\n",
+                          compiledFileName);
+        UnmapWholeFile(contents, length);
+        return false;
+    }
+
+    if (sourceFileName != NULL && !SourceFileMatches(sourceFileName, &header))
+    {
+        LOG_DEBUG(LogInput, "'%s' changed since '%s' was compiled from it", sourceFileName, compiledFileName);
+        UnmapWholeFile(contents, length);
+        return false;
+    }
+
+    fileData->schedulerType = (SchedulerType)header.schedulerType;
+    fileData->timeQuantum = header.timeQuantum;
+    fileData->runLength = header.runLength;
+    if (!VectorCreate(sizeof(InputProcess), header.processCount, 0, NULL, ProcessArrivalCompareTo,
+                      &fileData->processes))
+    {
+        UnmapWholeFile(contents, length);
+        return false;
+    }
+
+    // The records are already in arrival order, so they are only copied out.
+    const unsigned char* strings = contents + header.stringTableOffset;
+    uint64_t stringTableSize = length - header.stringTableOffset;
+    for (uint32_t i = 0; loaded && i < header.processCount; i++)
+    {
+        CompiledProcess record;
+        memcpy(&record, contents + sizeof(header) + (uint64_t)i * sizeof(record), sizeof(record));
+
+        InputProcess process;
+        loaded = record.nameLength < sizeof(process.processName) && record.nameOffset <= stringTableSize &&
+                 record.nameLength <= stringTableSize - record.nameOffset &&
+                 (record.commandLength == COMPILED_SCHEDULE_NO_COMMAND ||
+                  (record.commandOffset <= stringTableSize &&
+                   record.commandLength <= stringTableSize - record.commandOffset));
+        if (!loaded)
+            break;
+
+        memcpy(process.processName, strings + record.nameOffset, record.nameLength);
+        process.processName[record.nameLength] = '\0';
+        process.arrivalTime = record.arrivalTime;
+        process.burstLength = record.burstLength;
+        process.remainingTime = record.burstLength;
+        process.waitingTime = 0;
+        process.turnaroundTime = 0;
+        process.command = NULL;
+        if (record.commandLength != COMPILED_SCHEDULE_NO_COMMAND)
+        {
+            process.command = malloc((size_t)record.commandLength + 1);
+            memcpy(process.command, strings + record.commandOffset, record.commandLength);
+            process.command[record.commandLength] = '\0';
+        }
+
+        VectorAdd(&process, fileData->processes);
+    }
+
+    if (!loaded)
+        REPORT_LOAD_ERROR("The compiled schedule '%s' is damaged.\n", compiledFileName);
+
+    UnmapWholeFile(contents, length);
+    return loaded;
+}
+
+bool ReadScheduleFileCompiled(ScheduleData* fileData)
+{
+    if (LoadCompiledSchedule("processes.sched", "processes.in", fileData))
+    {
+        LOG_DEBUG(LogInput, "Loaded 'processes.sched' instead of reading 'processes.in'");
+        return true;
+    }
+    DestroyScheduleFile(fileData);
+
+    // Describe the text file before reading it, so that if it changes in between, the compiled schedule is stale
+    // rather than wrong.
+    CompiledScheduleHeader header = { 0 };
+    bool described = DescribeSourceFile("processes.in", &header);
+
+    if (!ReadScheduleFile(fileData))
+        return false;
+
+    // Not being able to keep the compiled schedule only makes the next run slower.
+    if (!described || !WriteCompiledSchedule(fileData, &header, "processes.sched"))
+        LOG_WARN(LogInput, "Failed to write 'processes.sched' for the next run");
+
+    return true;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file CompiledSchedule.h
+ *
+ * A binary form of a processes file, which loads without being lexed, parsed or sorted.
+ *
+ * A compiled schedule is a header with the scheduler settings, then a fixed size record for every process, already
+ * sorted by arrival, and then a table of the processes' names and commands, which the records refer to by offset.
+ * The header also describes the text file it was compiled from, so that a compiled schedule kept next to the text
+ * file can be checked against it and reused for as long as the text file is unchanged.
+ */
+
+#pragma once
+
+#include "ScheduleFile.h"
+#include <stdbool.h>
+
+/**
+ * @brief Writes a schedule that was read in to a compiled schedule file.
+ *
+ * The file is written to a temporary file and renamed into place, so a run that loads it at the same time never sees
+ * half of it.
+ *
+ * @param fileData The schedule to compile. Its processes must be sorted by arrival, as ReadScheduleFile leaves them.
+ * @param sourceFileName The text file the schedule was read from, which is recorded so that the compiled schedule can
+ * be checked against it later. May be NULL if the schedule did not come from a file.
+ * @param compiledFileName The name of the compiled schedule file to write.
+ * @return True if the file was written, otherwise false.
+ */
+bool CompileSchedule(ScheduleData* fileData, const char* sourceFileName, const char* compiledFileName);
+
+/**
+ * @brief Loads a compiled schedule file.
+ *
+ * The file is mapped into memory and its records are copied straight into the processes vector, in the order they are
+ * stored in. A call to DestroyScheduleFile is necessary after use, even if loading fails.
+ *
+ * @param compiledFileName The compiled schedule file to load.
+ * @param sourceFileName If not NULL, the file is only loaded if it was compiled from this text file as it is now: the
+ * text file's size and modification time have to match, and then so does a hash of its contents.
+ * @param fileData The ScheduleData object to fill in.
+ * @return True if the file was loaded, otherwise false.
+ */
+bool LoadCompiledSchedule(const char* compiledFileName, const char* sourceFileName, ScheduleData* fileData);
+
+/**
+ * @brief Reads "processes.in", reusing the compiled schedule kept next to it when it is up to date.
+ *
+ * If "processes.sched" was compiled from "processes.in" as it is now, it is loaded instead. Otherwise "processes.in"
+ * is read as usual with ReadScheduleFile, and compiled to "processes.sched" for the next run.
+ *
+ * @param fileData The ScheduleData object to fill in.
+ * @return True if the schedule was read, otherwise false.
+ */
+bool ReadScheduleFileCompiled(ScheduleData* fileData);
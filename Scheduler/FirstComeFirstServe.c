@@ -4,57 +4,56 @@
 
 #include "FirstComeFirstServe.h"
 #include "ScheduleFile.h"
+#include "Log.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
 
-void RunFCFSProcess (ScheduleData* inputData){
-	bool debug = false;		
-	
-	if(debug) printf("Starting FCFS\n");
-
-	FILE *out = fopen("processes.out", "w");
-	if(out == NULL) {
-		printf("Error opening output file\n");
-		return;
-	}
-	if(debug) printf("Opened processes.out\n");
-
+void RunFCFSProcess (ScheduleData* inputData, Trace* trace){
 	int numProc = VectorCount(inputData->processes);
 
-	if(debug) printf("%d processes\nUsing First Come First Served\n\n", numProc);
-	fprintf(out, "%d processes\nUsing First Come First Served\n\n", numProc);
+	LOG_DEBUG(LogFCFS, "Starting First Come First Served with %d processes", numProc);
+	TracePrintf(trace, "%d processes\nUsing First Come First Served\n\n", numProc);
 
 	/*
 	* How-to:
 	* Processes are completed in the order they are received.
 	*/
 
-	Vector* queue;
-	VectorCreate(sizeof(InputProcess), numProc, 0, NULL, NULL, &queue);
+	// The queue is typed, so getting a process from it is just an index.
+	InputProcessVector queue;
+	InputProcessVectorCreate(numProc, &queue);
 	int head, tail, clock;
 	head = tail = clock = 0;
 	bool running = false;
+
+	// Each arrival is a timer on the wheel, so a tick only touches the processes that actually arrive on it.
+	TimingWheel* arrivals;
+	TimingWheelCreate(sizeof(int), 0, &arrivals);
+	for (int i = 0; i < numProc; ++i) {
+		InputProcess* process = VectorGet(i, inputData->processes);
+		TimingWheelSchedule(&i, process->arrivalTime, NULL, arrivals);
+	}
 	
-	if(debug) printf("Beginning processing:\n");
+	LOG_DEBUG(LogFCFS, "Beginning processing, running for %d", inputData->runLength);
 	for (; clock <= inputData->runLength; ++clock) 
 	{
-		// Iterate through processes to check for new arrivals
-		for (int i = 0; i < numProc; ++i) {
+		// Collect the processes arriving now
+		int i;
+		TimingWheelAdvance(clock, arrivals);
+		while (TimingWheelPopExpired(&i, NULL, arrivals)) {
 			InputProcess* process = VectorGet(i, inputData->processes);
-			if (process->arrivalTime == clock) {
-				if(debug) printf("Time %d: %s arrived\n", clock, process->processName);
-				fprintf(out, "Time %d: %s arrived\n", clock, process->processName);
-				process->remainingTime = process->burstLength;
-				VectorAdd(process, queue);
-				++tail;
-			}
+			LOG_TRACE(LogFCFS, "Time %d: %s arrived", clock, process->processName);
+			TraceArrived(clock, process->processName, trace);
+			process->remainingTime = process->burstLength;
+			InputProcessVectorPush(process, &queue);
+			++tail;
 		}
 		// Check if we have at least one ready process
 		if(head != tail){
 
 			// Check if head has finished
-			InputProcess* headProcess = VectorGet(head, queue);
+			InputProcess* headProcess = InputProcessVectorGet(head, &queue);
 			if(headProcess->arrivalTime != clock){
 				headProcess->remainingTime -= 1;
 				headProcess->turnaroundTime += 1;
@@ -62,7 +61,7 @@ void RunFCFSProcess (ScheduleData* inputData){
 
 			// Update everything else
 			for(int i = head+1; i < tail; ++i){
-				InputProcess* thisProcess = VectorGet(i, queue);
+				InputProcess* thisProcess = InputProcessVectorGet(i, &queue);
 				if(thisProcess->arrivalTime != clock){
 					thisProcess->turnaroundTime += 1;
 					thisProcess->waitingTime += 1;
@@ -70,34 +69,40 @@ void RunFCFSProcess (ScheduleData* inputData){
 			}
 
 			if(headProcess->remainingTime == 0){
-				if(debug) printf("Time %d: %s finished\n", clock, headProcess->processName);
-				fprintf(out, "Time %d: %s finished\n", clock, headProcess->processName);
+				LOG_TRACE(LogFCFS, "Time %d: %s finished", clock, headProcess->processName);
+				TraceFinished(clock, headProcess->processName, trace);
 				running = false;
 				++head;
 			}
 
 			// If head has finished or we are idle, and there is still at least one ready process, select a new process
 			if(!running && head != tail){
-				InputProcess* newProcess = VectorGet(head, queue);
-				if(debug) printf("Time %d: %s selected (burst %d)\n", clock, newProcess->processName, newProcess->burstLength);
-				fprintf(out, "Time %d: %s selected (burst %d)\n", clock, newProcess->processName, newProcess->burstLength);
+				InputProcess* newProcess = InputProcessVectorGet(head, &queue);
+				LOG_TRACE(LogFCFS, "Time %d: %s selected (burst %d)", clock, newProcess->processName, newProcess->burstLength);
+				TraceSelected(clock, newProcess->processName, newProcess->burstLength, trace);
 				running = true;
 			}
 		}
 		// No ready processes means we're Idle
 		else {
-			if(debug) printf("Time %d: IDLE\n", clock);
-			fprintf(out, "Time %d: IDLE\n", clock);
+			LOG_TRACE(LogFCFS, "Time %d: IDLE", clock);
+			TraceIdle(clock, trace);
 		}		
+
+		// Count the tick in the utilization timeline, if there is one
+		TraceTick(clock, head != tail, tail - head, trace);
 	}		
 	// Show results
-	if(debug) printf("Finished at time %d\n\n", clock-1);
-	fprintf(out, "Finished at time %d\n\n", clock-1);
+	LOG_DEBUG(LogFCFS, "Finished at time %d, %d of %d processes arrived", clock-1, tail, numProc);
+	TracePrintf(trace, "Finished at time %d\n\n", clock-1);
 	for(int i = 0; i < tail; ++i){
-		InputProcess* thisProcess = VectorGet(i, queue);
-		if(debug) printf("%s wait %d turnaround %d\n", thisProcess->processName, thisProcess->waitingTime, thisProcess->turnaroundTime);
-		fprintf(out, "%s wait %d turnaround %d\n", thisProcess->processName, thisProcess->waitingTime, thisProcess->turnaroundTime);
+		InputProcess* thisProcess = InputProcessVectorGet(i, &queue);
+		LOG_TRACE(LogFCFS, "%s wait %d turnaround %d", thisProcess->processName, thisProcess->waitingTime, thisProcess->turnaroundTime);
+		TracePrintf(trace, "%s wait %d turnaround %d\n", thisProcess->processName, thisProcess->waitingTime, thisProcess->turnaroundTime);
 	}
 
-	fclose(out);
+	// The trace holds on to process names from the queue until it is flushed.
+	TraceFlush(trace);
+	TimingWheelDestroy(&arrivals);
+	InputProcessVectorDestroy(&queue);
 }
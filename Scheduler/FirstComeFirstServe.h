@@ -4,4 +4,5 @@
 
 #pragma once
 #include "ScheduleFile.h"
-void RunFCFSProcess (ScheduleData* inputData);
+#include "Trace.h"
+void RunFCFSProcess (ScheduleData* inputData, Trace* trace);
@@ -18,28 +18,79 @@ typedef struct tagLexer
      */
     Scanner* scanner;
     /**
-     * A vector that contains all the tokens, in the order they were found in the file.
+     * The token that LexerPeekToken read ahead, if hasPeekedToken is set. LexerNextToken hands it out before reading
+     * any further.
      */
-    Vector* tokens;
+    LexerToken peekedToken;
+    bool hasPeekedToken;
 } Lexer;
 
+/**
+ * Works out which keyword a word is. Every keyword is told apart by its length and first character, so this is a
+ * couple of jumps and at most one memcmp.
+ */
+static Keyword LexerClassifyWord(const char* word, unsigned int length)
+{
+#define MATCH_KEYWORD(text, keyword) return memcmp(word, text, sizeof(text) - 1) == 0 ? keyword : NotKeyword
+
+    switch (length)
+    {
+        case 2:
+            if (word[0] == 'r')
+                MATCH_KEYWORD("rr", KeywordRR);
+            break;
+        case 3:
+            switch (word[0])
+            {
+                case 'u': MATCH_KEYWORD("use", KeywordUse);
+                case 'e': MATCH_KEYWORD("end", KeywordEnd);
+                case 's': MATCH_KEYWORD("sjf", KeywordSJF);
+            }
+            break;
+        case 4:
+            switch (word[0])
+            {
+                case 'n': MATCH_KEYWORD("name", KeywordName);
+                case 'f': MATCH_KEYWORD("fcfs", KeywordFCFS);
+            }
+            break;
+        case 5:
+            if (word[0] == 'b')
+                MATCH_KEYWORD("burst", KeywordBurst);
+            break;
+        case 6:
+            if (word[0] == 'r')
+                MATCH_KEYWORD("runfor", KeywordRunFor);
+            break;
+        case 7:
+            switch (word[0])
+            {
+                case 'q': MATCH_KEYWORD("quantum", KeywordQuantum);
+                case 'p': MATCH_KEYWORD("process", KeywordProcess);
+                case 'a': MATCH_KEYWORD("arrival", KeywordArrival);
+                case 'c': MATCH_KEYWORD("command", KeywordCommand);
+            }
+            break;
+        case 12:
+            if (word[0] == 'p')
+                MATCH_KEYWORD("processcount", KeywordProcessCount);
+            break;
+    }
+
+#undef MATCH_KEYWORD
+
+    return NotKeyword;
+}
+
 bool LexerCreate(Lexer** lexer)
 {
     *lexer = calloc(1, sizeof(Lexer));
     if (*lexer == NULL)
         return false;
 
-    // Instantiate the vector.
-    if (!VectorCreate(sizeof(LexerToken), 50, 0, NULL, NULL, &(*lexer)->tokens))
-    {
-        free(*lexer);
-        return false;
-    }
-
     // Instantiate the scanner.
     if (!ScannerCreate(&(*lexer)->scanner))
     {
-        VectorDestroy(&(*lexer)->tokens);
         free(*lexer);
         return false;
     }
@@ -49,27 +100,19 @@ bool LexerCreate(Lexer** lexer)
 
 void LexerDestroy(Lexer** lexer)
 {
-    // Since the string value of a token is dynamically allocated, that memory needs to be freed.
-    // Go through each string token and free their string memory.
-    Vector* tokens = (*lexer)->tokens;
-    for (int i = 0; i < VectorCount(tokens); i++)
-    {
-        LexerToken* token = VectorGet(i, tokens);
-        if (token->tokenType == String && token->strTokenValue != NULL)
-        {
-            free(token->strTokenValue);
-            token->strTokenValue = NULL;
-        }
-    }
-
-    // Free everything else.
+    // The tokens' strings point into the scanner's contents, so destroying the scanner releases them.
     ScannerDestroy(&(*lexer)->scanner);
-    VectorDestroy(&(*lexer)->tokens);
     free(*lexer);
     *lexer = NULL;
 }
 
-bool LexerParseFile(const char* filename, Lexer* lexer)
+void LexerReset(Lexer* lexer)
+{
+    ScannerReset(lexer->scanner);
+    lexer->hasPeekedToken = false;
+}
+
+bool LexerOpenFile(const char* filename, Lexer* lexer)
 {
     // Direct the scanner to read the input file.
     if (!ScannerReadFile(filename, lexer->scanner))
@@ -78,6 +121,39 @@ bool LexerParseFile(const char* filename, Lexer* lexer)
         return false;
     }
 
+    lexer->hasPeekedToken = false;
+    return true;
+}
+
+bool LexerOpenBuffer(const char* buffer, size_t length, Lexer* lexer)
+{
+    // Direct the scanner to read the text.
+    if (!ScannerReadBuffer(buffer, length, lexer->scanner))
+    {
+        fprintf(stderr, "Scanner failed to read the text.\n");
+        return false;
+    }
+
+    lexer->hasPeekedToken = false;
+    return true;
+}
+
+void LexerGetText(const char** text, size_t* length, Lexer* lexer)
+{
+    ScannerGetContents(text, length, lexer->scanner);
+}
+
+bool LexerNextToken(Lexer* lexer, LexerToken* token)
+{
+    // Hand out the token that was read ahead, if there is one.
+    if (lexer->hasPeekedToken)
+    {
+        *token = lexer->peekedToken;
+        lexer->hasPeekedToken = false;
+        return true;
+    }
+
+    // Skip whitespace and comments until the scanner reaches the start of a token.
     Scanner* scan = lexer->scanner;
     while (!ScannerIsAtEnd(scan))
     {
@@ -85,33 +161,30 @@ bool LexerParseFile(const char* filename, Lexer* lexer)
         {
             case Alpha:
             {
-                // This is a word. Read the rest of the word and store it as a string token.
-                LexerToken token;
-                token.tokenType = String;
+                // This is a word. Read the rest of the word and return it as a string token.
+                token->tokenType = String;
 
                 // Read a string from input.
                 char* parsedString;
                 unsigned int currentWordLength;
                 ScannerReadNextString(&parsedString, &currentWordLength, scan);
 
-                // In order to use the word the scanner found, it has to be copied out and turned into a C String.
-                token.strTokenValue = calloc(currentWordLength + 1, sizeof(char));
-                memcpy(token.strTokenValue, parsedString, currentWordLength);
-                token.strTokenValue[currentWordLength] = '\0';
-
-                // Store the token.
-                VectorAdd(&token, lexer->tokens);
-
-                break;
+                // The token refers to the word where the scanner found it, rather than a copy.
+                token->strTokenValue = parsedString;
+                token->strTokenLength = currentWordLength;
+                token->numTokenValue = 0;
+                token->keyword = LexerClassifyWord(parsedString, currentWordLength);
+                return true;
             }
             case Digit:
             {
-                // This is a number. Read the number and store it as a numerical token.
-                LexerToken token;
-                token.tokenType = Number;
-                token.numTokenValue = (unsigned int)ScannerReadNextInteger(scan);
-                VectorAdd(&token, lexer->tokens);
-                break;
+                // This is a number. Read the number and return it as a numerical token.
+                token->tokenType = Number;
+                token->strTokenValue = NULL;
+                token->strTokenLength = 0;
+                token->keyword = NotKeyword;
+                token->numTokenValue = (unsigned int)ScannerReadNextInteger(scan);
+                return true;
             }
             case Symbol:
             {
@@ -121,11 +194,35 @@ bool LexerParseFile(const char* filename, Lexer* lexer)
                     // This line is a comment. Ignore the rest of the line.
                     ScannerMoveToNextLine(scan);
                 }
+                // Is the symbol the start of a quoted string?
+                else if (ScannerGetChar(scan) == '"')
+                {
+                    // Everything inside the quotes is kept as a single string token, spaces included.
+                    token->tokenType = String;
+
+                    char* parsedString;
+                    unsigned int currentStringLength;
+                    ScannerReadQuotedString(&parsedString, &currentStringLength, scan);
+
+                    token->strTokenValue = parsedString;
+                    token->strTokenLength = currentStringLength;
+                    token->numTokenValue = 0;
+                    token->keyword = NotKeyword;
+
+                    // The scanner is already past the closing quote.
+                    return true;
+                }
+                else
+                {
+                    // Any other symbol means nothing, so skip it.
+                    ScannerMoveForward(scan);
+                }
+                break;
             }
             case Whitespace:
             {
-                // Skip the whitespace.
-                ScannerMoveForward(scan);
+                // Skip the whole run of whitespace.
+                ScannerSkipWhitespace(scan);
                 break;
             }
             case EndFile:
@@ -133,24 +230,18 @@ bool LexerParseFile(const char* filename, Lexer* lexer)
         }
     }
 
-    return true;
+    return false;
 }
 
-Vector* LexerGetTokens(Lexer* lexer)
+bool LexerPeekToken(Lexer* lexer, LexerToken* token)
 {
-    Vector* copyVector;
-    if (!VectorCreate(sizeof(LexerToken), VectorCount(lexer->tokens), 0, NULL, NULL, &copyVector))
-    {
-        return NULL;
-    }
-
-    // Copy the contents of the lexer's vectors to give to the client.
-    if (!VectorCopy(copyVector, lexer->tokens))
+    if (!lexer->hasPeekedToken)
     {
-        VectorDestroy(&copyVector);
-        return NULL;
+        if (!LexerNextToken(lexer, &lexer->peekedToken))
+            return false;
+        lexer->hasPeekedToken = true;
     }
 
-    // Return the copy.
-    return copyVector;
-}
\ No newline at end of file
+    *token = lexer->peekedToken;
+    return true;
+}
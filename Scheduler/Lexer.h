@@ -4,8 +4,8 @@
 
 #pragma once
 
-#include <CLib/Vector.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 typedef enum tagTokenType
 {
@@ -13,6 +13,28 @@ typedef enum tagTokenType
     Number = 1
 } TokenType;
 
+/**
+ * The words that mean something in a processes file. The lexer recognizes them as it reads each word, so the parser
+ * never has to compare strings.
+ */
+typedef enum tagKeyword
+{
+    NotKeyword = 0,
+    KeywordProcessCount,
+    KeywordRunFor,
+    KeywordUse,
+    KeywordQuantum,
+    KeywordProcess,
+    KeywordEnd,
+    KeywordName,
+    KeywordArrival,
+    KeywordBurst,
+    KeywordCommand,
+    KeywordFCFS,
+    KeywordSJF,
+    KeywordRR
+} Keyword;
+
 /**
  * Represents a token that the lexer parsed from the scanner.
  */
@@ -23,11 +45,20 @@ typedef struct tagLexerToken
      */
     TokenType tokenType;
     /**
-     * The string value of the token, stored as a C String.
-     * - If tokenType = String, this is a dynamically allocated string that later needs to be released.
-     * - If tokenType = Number, this is null.
+     * The string value of the token, if tokenType = String. Otherwise, this is null.
+     * This points straight into the contents the lexer parsed, so it is not null terminated; strTokenLength gives its
+     * length. It stays valid until the lexer is destroyed or opened on something else.
+     */
+    const char* strTokenValue;
+    /**
+     * The length of the string value, if tokenType = String. Otherwise, this is just set to 0.
+     */
+    unsigned int strTokenLength;
+    /**
+     * The keyword the token's word is, if tokenType = String and the word was not quoted. Otherwise, this is
+     * NotKeyword.
      */
-    char* strTokenValue;
+    Keyword keyword;
     /**
      * The numerical value of the token, if tokenType = Number. Otherwise, this is just set to 0.
      */
@@ -53,17 +84,52 @@ bool LexerCreate(Lexer** lexer);
 void LexerDestroy(Lexer** lexer);
 
 /**
- * Directs the lexer to parse through a file, pulling out the tokens.
- * @param filename The filename that the lexer should parse.
- * @param lexer The lexer that should parse the file.
- * @return True if the parsing operation succeeds, otherwise false.
+ * Lets go of whatever the lexer was opened on, keeping its scanner and buffers so that it can be opened on the next
+ * file without allocating.
+ * @param lexer The lexer to reset.
+ */
+void LexerReset(Lexer* lexer);
+
+/**
+ * Directs the lexer to read a file. The tokens are then pulled out one at a time with LexerNextToken, so they are
+ * never all held at once.
+ * @param filename The filename that the lexer should read.
+ * @param lexer The lexer that should read the file.
+ * @return True if the file was read, otherwise false.
+ */
+bool LexerOpenFile(const char* filename, Lexer* lexer);
+
+/**
+ * Directs the lexer to read a block of text, such as just the part of a file that changed. The tokens are then
+ * pulled out one at a time with LexerNextToken. The text is not copied, so it must stay valid while the lexer reads it.
+ * @param buffer The text to read. It does not need to be null terminated.
+ * @param length The length of the text, in bytes.
+ * @param lexer The lexer that should read the text.
+ * @return True if the text was read, otherwise false.
+ */
+bool LexerOpenBuffer(const char* buffer, size_t length, Lexer* lexer);
+
+/**
+ * Gets the whole of the text the lexer was opened on, however far through it the lexer is.
+ * @param text Receives the text. It is not null terminated.
+ * @param length Receives the length of the text, in bytes.
+ * @param lexer The lexer to use.
+ */
+void LexerGetText(const char** text, size_t* length, Lexer* lexer);
+
+/**
+ * Pulls the next token out of whatever the lexer was opened on. The token's string stays valid until the lexer is
+ * destroyed or opened on something else.
+ * @param lexer The lexer to get the token from.
+ * @param token Receives the token.
+ * @return True if a token was found, or false at the end of the input.
  */
-bool LexerParseFile(const char* filename, Lexer* lexer);
+bool LexerNextToken(Lexer* lexer, LexerToken* token);
 
 /**
- * Gets the tokens from the lexer. Note that the returned vector needs to be destroyed
- * by the client.
- * @param lexer The lexer to get the tokens from.
- * @return The vector of tokens that the lexer parsed out.
+ * Gets the next token without moving past it, so that the next call to LexerNextToken returns it again.
+ * @param lexer The lexer to get the token from.
+ * @param token Receives the token.
+ * @return True if a token was found, or false at the end of the input.
  */
-Vector* LexerGetTokens(Lexer* lexer);
\ No newline at end of file
+bool LexerPeekToken(Lexer* lexer, LexerToken* token);
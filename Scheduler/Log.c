@@ -0,0 +1,187 @@
+/**
+ * @file Log.c
+ */
+
+#define _GNU_SOURCE
+
+#include "Log.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+/**
+ * The size of each thread's log buffer.
+ */
+#define LOG_BUFFER_SIZE 65536
+
+/**
+ * The longest message that is logged. Longer messages are cut short.
+ */
+#define LOG_MAX_MESSAGE_SIZE 1024
+
+/**
+ * A thread's log buffer.
+ */
+typedef struct tagLogBuffer
+{
+    char data[LOG_BUFFER_SIZE];
+    unsigned int length;
+    bool registered;
+} LogBuffer;
+
+unsigned int LogEnabledCategories = ~0u;
+
+/**
+ * The file descriptor the log is written to.
+ */
+static int LogDescriptor = STDERR_FILENO;
+
+/**
+ * The buffer of the calling thread.
+ */
+static __thread LogBuffer ThreadLogBuffer;
+
+/**
+ * Used to flush a thread's buffer when the thread exits.
+ */
+static pthread_key_t LogThreadKey;
+static pthread_once_t LogThreadKeyOnce = PTHREAD_ONCE_INIT;
+
+static const char* LogLevelNames[] = { "TRACE", "DEBUG", "INFO", "WARN", "ERROR" };
+static const char* LogCategoryNames[] = { "main", "input", "fcfs", "sjf", "rr", "real", "cache", "watch" };
+
+/**
+ * Writes out a buffer. Each call is a single write() where possible, so lines from different threads do not mix.
+ */
+static void LogFlushBuffer(LogBuffer* buffer)
+{
+    unsigned int written = 0;
+    while (written < buffer->length)
+    {
+        ssize_t result = write(LogDescriptor, buffer->data + written, buffer->length - written);
+        if (result <= 0)
+            break;
+        written += (unsigned int)result;
+    }
+    buffer->length = 0;
+}
+
+static void LogThreadExit(void* buffer)
+{
+    LogFlushBuffer(buffer);
+}
+
+static void LogCreateThreadKey()
+{
+    pthread_key_create(&LogThreadKey, LogThreadExit);
+}
+
+bool LogOpen(const char* fileName)
+{
+    int descriptor = open(fileName, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (descriptor == -1)
+    {
+        fprintf(stderr, "Failed to open the log file '%s'.\n", fileName);
+        return false;
+    }
+
+    LogFlush();
+    LogDescriptor = descriptor;
+    return true;
+}
+
+bool LogSetCategories(const char* names)
+{
+    unsigned int categories = 0;
+    bool recognized = true;
+
+    const char* name = names;
+    while (*name != '\0')
+    {
+        size_t length = strcspn(name, ",");
+        bool found = length == 3 && strncmp(name, "all", 3) == 0;
+        if (found)
+            categories = ~0u;
+
+        for (int i = 0; i < LogCategoryCount && !found; i++)
+        {
+            if (strlen(LogCategoryNames[i]) == length && strncmp(name, LogCategoryNames[i], length) == 0)
+            {
+                categories |= 1u << i;
+                found = true;
+            }
+        }
+
+        if (!found)
+        {
+            fprintf(stderr, "Unknown log category '%.*s'.\n", (int)length, name);
+            recognized = false;
+        }
+
+        name += length;
+        if (*name == ',')
+            name++;
+    }
+
+    LogEnabledCategories = categories;
+    return recognized;
+}
+
+void LogWrite(int level, LogCategory category, const char* format, ...)
+{
+    LogBuffer* buffer = &ThreadLogBuffer;
+
+    // Make sure whatever the thread logs is written out when it exits.
+    if (!buffer->registered)
+    {
+        pthread_once(&LogThreadKeyOnce, LogCreateThreadKey);
+        pthread_setspecific(LogThreadKey, buffer);
+        buffer->registered = true;
+    }
+
+    // Make room for the longest message first, so that formatting never has to be undone.
+    if (LOG_BUFFER_SIZE - buffer->length < LOG_MAX_MESSAGE_SIZE)
+        LogFlushBuffer(buffer);
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    char* line = buffer->data + buffer->length;
+    int length = snprintf(line, LOG_MAX_MESSAGE_SIZE, "%lld.%06ld %s %s: ", (long long)now.tv_sec,
+                          now.tv_nsec / 1000, LogLevelNames[level], LogCategoryNames[category]);
+
+    va_list arguments;
+    va_start(arguments, format);
+    length += vsnprintf(line + length, LOG_MAX_MESSAGE_SIZE - length - 1, format, arguments);
+    va_end(arguments);
+
+    // A message that was cut short still ends its line.
+    if (length > LOG_MAX_MESSAGE_SIZE - 2)
+        length = LOG_MAX_MESSAGE_SIZE - 2;
+    line[length++] = '\n';
+    buffer->length += (unsigned int)length;
+
+    // Warnings and errors are written out right away, since they may be the last thing logged.
+    if (level >= LOG_LEVEL_WARN)
+        LogFlushBuffer(buffer);
+}
+
+void LogFlush()
+{
+    LogFlushBuffer(&ThreadLogBuffer);
+}
+
+void LogClose()
+{
+    LogFlush();
+    if (LogDescriptor != STDERR_FILENO)
+    {
+        close(LogDescriptor);
+        LogDescriptor = STDERR_FILENO;
+    }
+}
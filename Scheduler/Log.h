@@ -0,0 +1,157 @@
+/**
+ * @file Log.h
+ *
+ * Leveled diagnostic logging for the scheduler.
+ *
+ * Every message has a level and a category. Levels below LOG_LEVEL are compiled out entirely, so their arguments are
+ * never even evaluated; LOG_LEVEL defaults to LOG_LEVEL_WARN and can be changed with -DLOG_LEVEL=LOG_LEVEL_TRACE and
+ * so on. Categories are switched on and off at run time.
+ *
+ * Each thread formats its messages into a buffer of its own, which is written out with a single write() call when it
+ * fills up, when LogFlush is called, when the thread exits, and after every warning or error. Logging therefore never
+ * takes a lock, and costs one formatted copy into memory per message.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+/**
+ * The log levels, from the most verbose to the least.
+ */
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_WARN 3
+#define LOG_LEVEL_ERROR 4
+#define LOG_LEVEL_OFF 5
+
+/**
+ * The lowest level that is compiled in.
+ */
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_WARN
+#endif
+
+/**
+ * The parts of the scheduler that log messages. Each can be switched on and off on its own.
+ */
+typedef enum tagLogCategory
+{
+    /**
+     * The command line and overall flow of the program.
+     */
+    LogMain = 0,
+    /**
+     * Reading and parsing the processes file.
+     */
+    LogInput = 1,
+    /**
+     * The First-Come First-Served scheduler.
+     */
+    LogFCFS = 2,
+    /**
+     * The Shortest Job First scheduler.
+     */
+    LogSJF = 3,
+    /**
+     * The Round-Robin scheduler.
+     */
+    LogRR = 4,
+    /**
+     * Running processes for real.
+     */
+    LogReal = 5,
+    /**
+     * The result cache.
+     */
+    LogCache = 6,
+    /**
+     * Watching the processes file for changes.
+     */
+    LogWatch = 7,
+
+    /**
+     * The number of categories.
+     */
+    LogCategoryCount
+} LogCategory;
+
+/**
+ * A bit for each category, set when the category is switched on. All categories start out switched on.
+ */
+extern unsigned int LogEnabledCategories;
+
+/**
+ * Checks whether messages of a level and category are logged. This is a compile time constant false for levels that
+ * are compiled out, so it can guard work that is only done for logging.
+ */
+#define LOG_IS_ENABLED(level, category) \
+    ((level) >= LOG_LEVEL && (level) < LOG_LEVEL_OFF && (LogEnabledCategories & (1u << (category))) != 0)
+
+#define LOG_AT(level, category, ...) \
+    do { if (LOG_IS_ENABLED(level, category)) LogWrite(level, category, __VA_ARGS__); } while (0)
+
+#if LOG_LEVEL <= LOG_LEVEL_TRACE
+#define LOG_TRACE(category, ...) LOG_AT(LOG_LEVEL_TRACE, category, __VA_ARGS__)
+#else
+#define LOG_TRACE(category, ...) ((void)0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(category, ...) LOG_AT(LOG_LEVEL_DEBUG, category, __VA_ARGS__)
+#else
+#define LOG_DEBUG(category, ...) ((void)0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(category, ...) LOG_AT(LOG_LEVEL_INFO, category, __VA_ARGS__)
+#else
+#define LOG_INFO(category, ...) ((void)0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(category, ...) LOG_AT(LOG_LEVEL_WARN, category, __VA_ARGS__)
+#else
+#define LOG_WARN(category, ...) ((void)0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(category, ...) LOG_AT(LOG_LEVEL_ERROR, category, __VA_ARGS__)
+#else
+#define LOG_ERROR(category, ...) ((void)0)
+#endif
+
+/**
+ * Sends the log to a file instead of stderr. The file is appended to.
+ * @param fileName The name of the file to log to.
+ * @return True if the file was opened, otherwise false.
+ */
+bool LogOpen(const char* fileName);
+
+/**
+ * Switches on only the categories named in a comma separated list, such as "fcfs,rr". The names are the category
+ * names without the "Log" prefix, in lower case, and "all" switches on every category.
+ * @param names The list of category names.
+ * @return False if a name was not recognized, otherwise true.
+ */
+bool LogSetCategories(const char* names);
+
+/**
+ * Formats a message into the calling thread's log buffer. Use the LOG_ macros instead, so that disabled levels are
+ * compiled out.
+ * @param level The level of the message.
+ * @param category The category of the message.
+ * @param format The printf format of the message. A newline is added at the end.
+ */
+void LogWrite(int level, LogCategory category, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+/**
+ * Writes out everything the calling thread has logged so far.
+ */
+void LogFlush();
+
+/**
+ * Writes out the calling thread's messages and closes the log file, if one was opened.
+ */
+void LogClose();
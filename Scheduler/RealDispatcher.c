@@ -0,0 +1,407 @@
+/**
+ * @file RealDispatcher.c
+ */
+
+#define _GNU_SOURCE
+
+#include "RealDispatcher.h"
+#include "Log.h"
+#include <CLib/CLibraryExtensions.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/timerfd.h>
+
+/**
+ * The state of one real child process.
+ */
+typedef struct tagRealProcess
+{
+    /**
+     * The process from the schedule that this child runs.
+     */
+    InputProcess* process;
+
+    /**
+     * The process ID of the child, which is also the ID of its process group. 0 until the process arrives.
+     */
+    pid_t pid;
+
+    /**
+     * True once the child's command has exited.
+     */
+    bool finished;
+
+    /**
+     * The number of time units the child has been allowed to run.
+     */
+    unsigned int ranTicks;
+
+    /**
+     * The number of time units the child spent ready to run but stopped.
+     */
+    unsigned int waitingTicks;
+
+    /**
+     * The number of time units from the child's arrival until it finished.
+     */
+    unsigned int turnaroundTicks;
+} RealProcess;
+
+/**
+ * Pins the calling thread to the first CPU it is allowed to run on, and saves the CPUs it was allowed to run on so
+ * they can be restored when the run is over. Children forked from the thread inherit the affinity.
+ */
+static bool PinToSingleCpu(cpu_set_t* allowed)
+{
+    if (sched_getaffinity(0, sizeof(*allowed), allowed) == -1)
+        return false;
+
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    {
+        if (CPU_ISSET(cpu, allowed))
+        {
+            cpu_set_t single;
+            CPU_ZERO(&single);
+            CPU_SET(cpu, &single);
+            return sched_setaffinity(0, sizeof(single), &single) == 0;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Starts the command of a process in a stopped state, in its own process group.
+ */
+static bool StartStopped(RealProcess* realProcess)
+{
+    pid_t pid = fork();
+    if (pid == -1)
+        return false;
+
+    if (pid == 0)
+    {
+        // Put the command in its own process group, so that stopping the group also stops anything the shell
+        // starts. Then wait to be dispatched before running the command.
+        setpgid(0, 0);
+        raise(SIGSTOP);
+        execl("/bin/sh", "sh", "-c", realProcess->process->command, (char*)NULL);
+        _exit(127);
+    }
+
+    // Set the process group from the parent as well, so it is in place whichever side runs first, and wait for the
+    // child to stop itself.
+    setpgid(pid, pid);
+    int status;
+    if (waitpid(pid, &status, WUNTRACED) == -1 || !WIFSTOPPED(status))
+        return false;
+
+    realProcess->pid = pid;
+    return true;
+}
+
+/**
+ * Gets the remaining burst estimate of a process.
+ */
+static unsigned int RemainingEstimate(RealProcess* realProcess)
+{
+    unsigned int burst = realProcess->process->burstLength;
+    return realProcess->ranTicks < burst ? burst - realProcess->ranTicks : 0;
+}
+
+/**
+ * Removes a process index from the ready queue.
+ */
+static void RemoveFromReady(int index, Vector* ready)
+{
+    for (unsigned int i = 0; i < VectorCount(ready); i++)
+    {
+        if (*(int*)VectorGet(i, ready) == index)
+        {
+            VectorRemove(i, ready);
+            return;
+        }
+    }
+}
+
+/**
+ * Tells whether the process an index in the ready queue refers to has finished.
+ */
+static bool ReadyProcessFinished(const void* index, void* processes)
+{
+    return ((RealProcess*)processes)[*(const int*)index].finished;
+}
+
+/**
+ * Picks the process that should run for the next time unit. The ready queue holds the processes that are waiting,
+ * in the order the policy serves them; the running process is not in it.
+ */
+static int PickNext(ScheduleData* inputData, RealProcess* processes, Vector* ready, int running)
+{
+    switch (inputData->schedulerType)
+    {
+        case FCFS:
+            // The running process keeps the CPU until it finishes.
+            if (running != -1 || VectorIsEmpty(ready))
+                return running;
+            return *(int*)VectorGet(0, ready);
+
+        case ShortestJob:
+        {
+            // The ready process with the least remaining time wins, preempting the running process only if it is
+            // strictly shorter.
+            int best = running;
+            for (unsigned int i = 0; i < VectorCount(ready); i++)
+            {
+                int candidate = *(int*)VectorGet(i, ready);
+                if (best == -1 || RemainingEstimate(&processes[candidate]) < RemainingEstimate(&processes[best]))
+                    best = candidate;
+            }
+            return best;
+        }
+
+        case RoundRobin:
+            // The running process keeps the CPU until its quantum is used up, which the caller handles by putting it
+            // back in the ready queue.
+            if (running != -1 || VectorIsEmpty(ready))
+                return running;
+            return *(int*)VectorGet(0, ready);
+    }
+
+    return running;
+}
+
+bool RunRealProcesses(ScheduleData* inputData, unsigned int tickMilliseconds, Trace* trace)
+{
+    int numProc = VectorCount(inputData->processes);
+
+    // Every process needs something to run.
+    for (int i = 0; i < numProc; i++)
+    {
+        InputProcess* process = VectorGet(i, inputData->processes);
+        if (process->command == NULL)
+        {
+            fprintf(stderr, "Process %s has no command to run.\n", process->processName);
+            return false;
+        }
+    }
+
+    if (tickMilliseconds == 0)
+    {
+        fprintf(stderr, "The length of a time unit must be at least 1 millisecond.\n");
+        return false;
+    }
+
+    // One time unit is one expiration of a periodic timer.
+    int timer = timerfd_create(CLOCK_MONOTONIC, 0);
+    if (timer == -1)
+    {
+        fprintf(stderr, "Failed to create the dispatch timer.\n");
+        return false;
+    }
+    struct itimerspec period;
+    period.it_interval.tv_sec = tickMilliseconds / 1000;
+    period.it_interval.tv_nsec = (long)(tickMilliseconds % 1000) * 1000000L;
+    period.it_value = period.it_interval;
+
+    cpu_set_t allowedCpus;
+    if (!PinToSingleCpu(&allowedCpus))
+    {
+        fprintf(stderr, "Failed to pin the dispatcher to a single CPU.\n");
+        close(timer);
+        return false;
+    }
+
+    switch (inputData->schedulerType)
+    {
+        case FCFS:
+            TracePrintf(trace, "%d processes\nUsing First Come First Served\n\n", numProc);
+            break;
+        case ShortestJob:
+            TracePrintf(trace, "%d processes\nUsing Shortest Job First (Pre)\n\n", numProc);
+            break;
+        case RoundRobin:
+            TracePrintf(trace, "%d processes\nUsing Round Robin\nQuantum %d\n\n", numProc, inputData->timeQuantum);
+            break;
+    }
+
+    RealProcess* processes = calloc(numProc > 0 ? numProc : 1, sizeof(RealProcess));
+    for (int i = 0; i < numProc; i++)
+        processes[i].process = VectorGet(i, inputData->processes);
+
+    // Arrivals come off a timing wheel, the same way the simulators get them.
+    TimingWheel* arrivals;
+    TimingWheelCreate(sizeof(int), 0, &arrivals);
+    for (int i = 0; i < numProc; i++)
+        TimingWheelSchedule(&i, processes[i].process->arrivalTime, NULL, arrivals);
+
+    Vector* ready;
+    VectorCreate(sizeof(int), numProc, 0, NULL, NULL, &ready);
+
+    int running = -1;
+    unsigned int quantumUsed = 0;
+    unsigned int clock = 0;
+    bool succeeded = true;
+
+    timerfd_settime(timer, 0, &period, NULL);
+
+    for (; clock <= inputData->runLength; ++clock)
+    {
+        // Collect the children whose commands exited during the last time unit.
+        int status;
+        pid_t exited;
+        bool anyReadyFinished = false;
+        while ((exited = waitpid(-1, &status, WNOHANG)) > 0)
+        {
+            for (int i = 0; i < numProc; i++)
+            {
+                if (processes[i].pid != exited)
+                    continue;
+
+                processes[i].finished = true;
+                LOG_DEBUG(LogReal, "Time %d: process group %d (%s) exited with status %d", clock, (int)exited,
+                          processes[i].process->processName, status);
+                TraceFinished(clock, processes[i].process->processName, trace);
+                if (running == i)
+                    running = -1;
+                else
+                    anyReadyFinished = true;
+                break;
+            }
+        }
+
+        // Take all the processes that finished while waiting out of the ready queue in one pass.
+        if (anyReadyFinished)
+            VectorRemoveIf(ReadyProcessFinished, processes, ready);
+
+        // Start the processes arriving now.
+        int i;
+        TimingWheelAdvance(clock, arrivals);
+        while (TimingWheelPopExpired(&i, NULL, arrivals))
+        {
+            if (!StartStopped(&processes[i]))
+            {
+                fprintf(stderr, "Failed to start process %s.\n", processes[i].process->processName);
+                succeeded = false;
+                break;
+            }
+            VectorAdd(&i, ready);
+            LOG_DEBUG(LogReal, "Time %d: started %s as process group %d", clock, processes[i].process->processName,
+                      (int)processes[i].pid);
+            TraceArrived(clock, processes[i].process->processName, trace);
+        }
+        if (!succeeded)
+            break;
+
+        // Did we run out of time?
+        if (clock == inputData->runLength)
+            break;
+
+        // A Round-Robin process that used up its quantum goes to the back of the ready queue.
+        int previous = running;
+        if (inputData->schedulerType == RoundRobin && running != -1 && quantumUsed >= inputData->timeQuantum)
+        {
+            VectorAdd(&running, ready);
+            running = -1;
+        }
+
+        // Switch to whichever process the policy picks.
+        int next = PickNext(inputData, processes, ready, running);
+        if (next != running)
+        {
+            // A process that was preempted goes back to the ready queue.
+            if (running != -1)
+                VectorAdd(&running, ready);
+            if (previous != -1 && previous != next)
+            {
+                LOG_TRACE(LogReal, "Time %d: stopping %s", clock, processes[previous].process->processName);
+                kill(-processes[previous].pid, SIGSTOP);
+            }
+
+            if (next != -1)
+            {
+                RemoveFromReady(next, ready);
+                if (next != previous)
+                    kill(-processes[next].pid, SIGCONT);
+                TraceSelected(clock, processes[next].process->processName, RemainingEstimate(&processes[next]), trace);
+                quantumUsed = 0;
+            }
+            running = next;
+        }
+        if (running == -1)
+        {
+            TraceIdle(clock, trace);
+        }
+
+        // Count the tick in the utilization timeline, if there is one.
+        TraceTick(clock, running != -1, VectorCount(ready) + (running != -1 ? 1 : 0), trace);
+
+        // Let the time unit pass. If the dispatcher woke up late, the timer has expired more than once, and the
+        // running process kept the CPU for all of those time units, but no more than are left in the run.
+        uint64_t expirations = 1;
+        while (read(timer, &expirations, sizeof(expirations)) == -1 && errno == EINTR)
+            ;
+        uint64_t left = inputData->runLength - clock;
+        unsigned int elapsed = (unsigned int)(expirations < left ? expirations : left);
+        if (expirations > 1)
+        {
+            LOG_WARN(LogReal, "Time %d: the dispatcher woke up late, %llu time units passed", clock,
+                     (unsigned long long)expirations);
+        }
+
+        // Account for the time units that just passed.
+        if (running != -1)
+        {
+            processes[running].ranTicks += elapsed;
+            processes[running].turnaroundTicks += elapsed;
+            quantumUsed += elapsed;
+        }
+        for (unsigned int j = 0; j < VectorCount(ready); j++)
+        {
+            RealProcess* waiting = &processes[*(int*)VectorGet(j, ready)];
+            waiting->waitingTicks += elapsed;
+            waiting->turnaroundTicks += elapsed;
+        }
+
+        // The time units that were missed look like the one before them in the utilization timeline.
+        for (unsigned int missed = 1; missed < elapsed; missed++)
+            TraceTick(clock + missed, running != -1, VectorCount(ready) + (running != -1 ? 1 : 0), trace);
+        clock += elapsed - 1;
+    }
+
+    // Anything still running when time is up is killed.
+    for (int i = 0; i < numProc; i++)
+    {
+        if (processes[i].pid != 0 && !processes[i].finished)
+        {
+            kill(-processes[i].pid, SIGKILL);
+            waitpid(processes[i].pid, NULL, 0);
+        }
+    }
+
+    // Show results
+    TracePrintf(trace, "Finished at time %d\n\n", clock);
+    for (int i = 0; i < numProc; i++)
+    {
+        TracePrintf(trace, "%s wait %d turnaround %d\n", processes[i].process->processName, processes[i].waitingTicks,
+                    processes[i].turnaroundTicks);
+    }
+
+    VectorDestroy(&ready);
+    TimingWheelDestroy(&arrivals);
+    free(processes);
+    close(timer);
+
+    // Let the thread run anywhere it could before, so later runs and the threads it starts aren't stuck on one CPU.
+    sched_setaffinity(0, sizeof(allowedCpus), &allowedCpus);
+
+    return succeeded;
+}
@@ -0,0 +1,28 @@
+/**
+ * @file RealDispatcher.h
+ */
+
+#pragma once
+
+#include "ScheduleFile.h"
+#include "Trace.h"
+#include <stdbool.h>
+
+/**
+ * @brief Runs the processes of a schedule as real child processes, under the schedule's scheduling policy.
+ *
+ * Every process must name a command. When a process arrives its command is started through "/bin/sh -c" in a stopped
+ * state, and from then on the dispatcher decides which child may run by sending SIGCONT and SIGSTOP to the child's
+ * process group. The dispatcher and all of its children are pinned to a single host CPU so that they compete for one
+ * CPU the way the simulated processes do, and each simulated time unit is one period of a timerfd. A process finishes
+ * when its command exits; burst lengths are only used as the estimates that Shortest Job First picks by.
+ *
+ * The measured events, wait times and turnaround times are written to the trace in the same format the simulators
+ * use, so the two can be compared directly.
+ *
+ * @param inputData The schedule to run.
+ * @param tickMilliseconds The length of one time unit, in milliseconds.
+ * @param trace The trace to write the measured events and results to.
+ * @return True if the processes were run, otherwise false.
+ */
+bool RunRealProcesses(ScheduleData* inputData, unsigned int tickMilliseconds, Trace* trace);
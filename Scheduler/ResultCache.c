@@ -0,0 +1,476 @@
+/**
+ * @file ResultCache.c
+ */
+
+#define _GNU_SOURCE
+
+#include "ResultCache.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+/**
+ * Identifies the layout of the key and of entry files. Changing either means changing this.
+ */
+#define RESULT_CACHE_VERSION "scheduler-result-cache-1"
+
+/**
+ * The magic bytes at the start of every entry file.
+ */
+#define RESULT_CACHE_MAGIC "SRC1"
+
+/**
+ * The file name extension of cache entries.
+ */
+#define RESULT_CACHE_ENTRY_EXTENSION ".entry"
+
+/**
+ * Temporary files older than this many seconds were left behind by a worker that died, and are cleaned up.
+ */
+#define RESULT_CACHE_STALE_SECONDS 3600
+
+/**
+ * The size of the buffer used to copy files in and out of entries.
+ */
+#define RESULT_CACHE_COPY_BUFFER_SIZE 65536
+
+/**
+ * The state of a SHA-256 computation.
+ */
+typedef struct tagSha256
+{
+    uint32_t state[8];
+    unsigned char block[64];
+    size_t blockLength;
+    uint64_t totalLength;
+} Sha256;
+
+static const uint32_t Sha256RoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define SHA256_ROTATE(value, bits) (((value) >> (bits)) | ((value) << (32 - (bits))))
+
+static void Sha256Init(Sha256* sha)
+{
+    static const uint32_t initialState[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    memcpy(sha->state, initialState, sizeof(initialState));
+    sha->blockLength = 0;
+    sha->totalLength = 0;
+}
+
+static void Sha256ProcessBlock(Sha256* sha, const unsigned char* block)
+{
+    uint32_t schedule[64];
+    for (int i = 0; i < 16; i++)
+    {
+        schedule[i] = ((uint32_t)block[i * 4] << 24) | ((uint32_t)block[i * 4 + 1] << 16) |
+                      ((uint32_t)block[i * 4 + 2] << 8) | (uint32_t)block[i * 4 + 3];
+    }
+    for (int i = 16; i < 64; i++)
+    {
+        uint32_t s0 = SHA256_ROTATE(schedule[i - 15], 7) ^ SHA256_ROTATE(schedule[i - 15], 18) ^ (schedule[i - 15] >> 3);
+        uint32_t s1 = SHA256_ROTATE(schedule[i - 2], 17) ^ SHA256_ROTATE(schedule[i - 2], 19) ^ (schedule[i - 2] >> 10);
+        schedule[i] = schedule[i - 16] + s0 + schedule[i - 7] + s1;
+    }
+
+    uint32_t a = sha->state[0], b = sha->state[1], c = sha->state[2], d = sha->state[3];
+    uint32_t e = sha->state[4], f = sha->state[5], g = sha->state[6], h = sha->state[7];
+    for (int i = 0; i < 64; i++)
+    {
+        uint32_t s1 = SHA256_ROTATE(e, 6) ^ SHA256_ROTATE(e, 11) ^ SHA256_ROTATE(e, 25);
+        uint32_t choose = (e & f) ^ (~e & g);
+        uint32_t temp1 = h + s1 + choose + Sha256RoundConstants[i] + schedule[i];
+        uint32_t s0 = SHA256_ROTATE(a, 2) ^ SHA256_ROTATE(a, 13) ^ SHA256_ROTATE(a, 22);
+        uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t temp2 = s0 + majority;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp1;
+        d = c;
+        c = b;
+        b = a;
+        a = temp1 + temp2;
+    }
+
+    sha->state[0] += a;
+    sha->state[1] += b;
+    sha->state[2] += c;
+    sha->state[3] += d;
+    sha->state[4] += e;
+    sha->state[5] += f;
+    sha->state[6] += g;
+    sha->state[7] += h;
+}
+
+static void Sha256Update(Sha256* sha, const void* data, size_t length)
+{
+    const unsigned char* bytes = data;
+    sha->totalLength += length;
+
+    while (length > 0)
+    {
+        size_t chunk = 64 - sha->blockLength;
+        if (chunk > length)
+            chunk = length;
+        memcpy(sha->block + sha->blockLength, bytes, chunk);
+        sha->blockLength += chunk;
+        bytes += chunk;
+        length -= chunk;
+
+        if (sha->blockLength == 64)
+        {
+            Sha256ProcessBlock(sha, sha->block);
+            sha->blockLength = 0;
+        }
+    }
+}
+
+static void Sha256Final(Sha256* sha, unsigned char* digest)
+{
+    uint64_t bitLength = sha->totalLength * 8;
+
+    // Pad with a one bit, then zeros up to the last 8 bytes of a block, which hold the message length in bits.
+    unsigned char padding = 0x80;
+    Sha256Update(sha, &padding, 1);
+    padding = 0;
+    while (sha->blockLength != 56)
+        Sha256Update(sha, &padding, 1);
+
+    unsigned char lengthBytes[8];
+    for (int i = 0; i < 8; i++)
+        lengthBytes[i] = (unsigned char)(bitLength >> (56 - i * 8));
+    Sha256Update(sha, lengthBytes, 8);
+
+    for (int i = 0; i < 8; i++)
+    {
+        digest[i * 4] = (unsigned char)(sha->state[i] >> 24);
+        digest[i * 4 + 1] = (unsigned char)(sha->state[i] >> 16);
+        digest[i * 4 + 2] = (unsigned char)(sha->state[i] >> 8);
+        digest[i * 4 + 3] = (unsigned char)sha->state[i];
+    }
+}
+
+/**
+ * Hashes an unsigned integer in a fixed byte order, so keys are the same on every host.
+ */
+static void Sha256UpdateInteger(Sha256* sha, uint64_t value)
+{
+    unsigned char bytes[8];
+    for (int i = 0; i < 8; i++)
+        bytes[i] = (unsigned char)(value >> (i * 8));
+    Sha256Update(sha, bytes, sizeof(bytes));
+}
+
+/**
+ * Hashes a string along with its length, so that neighbouring strings cannot run into each other.
+ */
+static void Sha256UpdateString(Sha256* sha, const char* string)
+{
+    size_t length = string != NULL ? strlen(string) : 0;
+    Sha256UpdateInteger(sha, length);
+    Sha256Update(sha, string, length);
+}
+
+void ResultCacheComputeKey(ScheduleData* inputData, const unsigned int* settings, int settingCount,
+                           ResultCacheKey* key)
+{
+    Sha256 sha;
+    Sha256Init(&sha);
+
+    Sha256UpdateString(&sha, RESULT_CACHE_VERSION);
+    Sha256UpdateInteger(&sha, inputData->schedulerType);
+    Sha256UpdateInteger(&sha, inputData->runLength);
+    Sha256UpdateInteger(&sha, inputData->schedulerType == RoundRobin ? inputData->timeQuantum : 0);
+
+    Sha256UpdateInteger(&sha, (uint64_t)settingCount);
+    for (int i = 0; i < settingCount; i++)
+        Sha256UpdateInteger(&sha, settings[i]);
+
+    unsigned int processCount = VectorCount(inputData->processes);
+    Sha256UpdateInteger(&sha, processCount);
+    for (unsigned int i = 0; i < processCount; i++)
+    {
+        InputProcess* process = VectorGet(i, inputData->processes);
+        Sha256UpdateString(&sha, process->processName);
+        Sha256UpdateInteger(&sha, process->arrivalTime);
+        Sha256UpdateInteger(&sha, process->burstLength);
+    }
+
+    Sha256Final(&sha, key->bytes);
+}
+
+/**
+ * Builds the path of a file in the cache directory, named after the key.
+ */
+static char* ResultCacheEntryPath(const char* cacheDirectory, const ResultCacheKey* key, const char* suffix)
+{
+    size_t length = strlen(cacheDirectory) + 1 + RESULT_CACHE_KEY_SIZE * 2 + strlen(suffix) + 1;
+    char* path = malloc(length);
+    if (path == NULL)
+        return NULL;
+
+    int position = sprintf(path, "%s/", cacheDirectory);
+    for (int i = 0; i < RESULT_CACHE_KEY_SIZE; i++)
+        position += sprintf(path + position, "%02x", key->bytes[i]);
+    strcpy(path + position, suffix);
+
+    return path;
+}
+
+/**
+ * Builds the name of a temporary file that only this process writes to.
+ */
+static char* ResultCacheTemporaryPath(const char* path)
+{
+    size_t length = strlen(path) + 32;
+    char* temporaryPath = malloc(length);
+    if (temporaryPath != NULL)
+        snprintf(temporaryPath, length, "%s.tmp.%ld", path, (long)getpid());
+    return temporaryPath;
+}
+
+/**
+ * Copies a number of bytes from one file to another.
+ */
+static bool CopyBytes(FILE* source, FILE* destination, uint64_t length)
+{
+    char buffer[RESULT_CACHE_COPY_BUFFER_SIZE];
+    while (length > 0)
+    {
+        size_t chunk = length < sizeof(buffer) ? (size_t)length : sizeof(buffer);
+        if (fread(buffer, 1, chunk, source) != chunk || fwrite(buffer, 1, chunk, destination) != chunk)
+            return false;
+        length -= chunk;
+    }
+    return true;
+}
+
+static bool WriteInteger(FILE* file, uint64_t value)
+{
+    return fwrite(&value, sizeof(value), 1, file) == 1;
+}
+
+static bool ReadInteger(FILE* file, uint64_t* value)
+{
+    return fread(value, sizeof(*value), 1, file) == 1;
+}
+
+bool ResultCacheFetch(const char* cacheDirectory, const ResultCacheKey* key, const char** fileNames, int fileCount)
+{
+    char* entryPath = ResultCacheEntryPath(cacheDirectory, key, RESULT_CACHE_ENTRY_EXTENSION);
+    if (entryPath == NULL)
+        return false;
+
+    FILE* entry = fopen(entryPath, "rb");
+    if (entry == NULL)
+    {
+        // A miss.
+        free(entryPath);
+        return false;
+    }
+
+    // The entry has to hold exactly the files asked for, in the same order.
+    char magic[4];
+    uint64_t storedCount;
+    bool succeeded = fread(magic, sizeof(magic), 1, entry) == 1 && memcmp(magic, RESULT_CACHE_MAGIC, 4) == 0 &&
+                     ReadInteger(entry, &storedCount) && storedCount == (uint64_t)fileCount;
+
+    for (int i = 0; succeeded && i < fileCount; i++)
+    {
+        uint64_t nameLength, fileLength;
+        char* name = NULL;
+        succeeded = ReadInteger(entry, &nameLength) && nameLength == strlen(fileNames[i]) &&
+                    (name = malloc(nameLength)) != NULL && fread(name, 1, nameLength, entry) == nameLength &&
+                    memcmp(name, fileNames[i], nameLength) == 0 && ReadInteger(entry, &fileLength);
+        free(name);
+        if (!succeeded)
+            break;
+
+        // Restore the file under a temporary name first, so the real file is never seen half written.
+        char* temporaryPath = ResultCacheTemporaryPath(fileNames[i]);
+        FILE* output = temporaryPath != NULL ? fopen(temporaryPath, "wb") : NULL;
+        succeeded = output != NULL && CopyBytes(entry, output, fileLength);
+        if (output != NULL)
+            succeeded = (fclose(output) == 0) && succeeded;
+        succeeded = succeeded && rename(temporaryPath, fileNames[i]) == 0;
+        if (!succeeded && temporaryPath != NULL)
+            remove(temporaryPath);
+        free(temporaryPath);
+    }
+
+    fclose(entry);
+
+    // Mark the entry as recently used, so eviction keeps it around.
+    if (succeeded)
+        utimensat(AT_FDCWD, entryPath, NULL, 0);
+
+    free(entryPath);
+    return succeeded;
+}
+
+/**
+ * An entry file found while enforcing the size limit.
+ */
+typedef struct tagCacheEntryInfo
+{
+    char* path;
+    off_t size;
+    time_t lastUsed;
+} CacheEntryInfo;
+
+static int CacheEntryLastUsedCompareTo(const void* obj1, const void* obj2)
+{
+    const CacheEntryInfo* entry1 = obj1;
+    const CacheEntryInfo* entry2 = obj2;
+    return (entry1->lastUsed > entry2->lastUsed) - (entry1->lastUsed < entry2->lastUsed);
+}
+
+static unsigned long long CacheEntryLastUsedKey(const void* obj)
+{
+    const CacheEntryInfo* entry = obj;
+    return entry->lastUsed > 0 ? (unsigned long long)entry->lastUsed : 0;
+}
+
+/**
+ * Removes the least recently used entries until the cache fits within its size limit, and cleans up temporary files
+ * left behind by workers that died.
+ */
+static void ResultCacheEvict(const char* cacheDirectory, unsigned long long limitBytes)
+{
+    DIR* directory = opendir(cacheDirectory);
+    if (directory == NULL)
+        return;
+
+    Vector* entries;
+    if (!VectorCreate(sizeof(CacheEntryInfo), 64, 0, NULL, CacheEntryLastUsedCompareTo, &entries))
+    {
+        closedir(directory);
+        return;
+    }
+
+    unsigned long long totalBytes = 0;
+    time_t now = time(NULL);
+    struct dirent* directoryEntry;
+    while ((directoryEntry = readdir(directory)) != NULL)
+    {
+        const char* name = directoryEntry->d_name;
+        size_t nameLength = strlen(name);
+        bool isEntry = nameLength > strlen(RESULT_CACHE_ENTRY_EXTENSION) &&
+                       strcmp(name + nameLength - strlen(RESULT_CACHE_ENTRY_EXTENSION), RESULT_CACHE_ENTRY_EXTENSION) == 0;
+        bool isTemporary = strstr(name, ".tmp.") != NULL;
+        if (!isEntry && !isTemporary)
+            continue;
+
+        CacheEntryInfo info;
+        info.path = malloc(strlen(cacheDirectory) + nameLength + 2);
+        if (info.path == NULL)
+            continue;
+        sprintf(info.path, "%s/%s", cacheDirectory, name);
+
+        struct stat fileStats;
+        if (stat(info.path, &fileStats) == -1)
+        {
+            // Another worker removed it in the meantime.
+            free(info.path);
+            continue;
+        }
+
+        if (isTemporary)
+        {
+            if (now - fileStats.st_mtime > RESULT_CACHE_STALE_SECONDS)
+                remove(info.path);
+            free(info.path);
+            continue;
+        }
+
+        info.size = fileStats.st_size;
+        info.lastUsed = fileStats.st_mtime;
+        totalBytes += (unsigned long long)info.size;
+        VectorAdd(&info, entries);
+    }
+    closedir(directory);
+
+    // Remove the oldest entries first. Another worker may be removing the same ones, which is fine.
+    if (totalBytes > limitBytes && !VectorSortByKey(CacheEntryLastUsedKey, entries))
+        VectorSort(entries);
+    for (unsigned int i = 0; i < VectorCount(entries); i++)
+    {
+        CacheEntryInfo* info = VectorGet(i, entries);
+        if (totalBytes > limitBytes)
+        {
+            remove(info->path);
+            totalBytes -= (unsigned long long)info->size;
+        }
+        free(info->path);
+    }
+
+    VectorDestroy(&entries);
+}
+
+bool ResultCacheStore(const char* cacheDirectory, const ResultCacheKey* key, const char** fileNames, int fileCount,
+                      unsigned long long limitBytes)
+{
+    if (mkdir(cacheDirectory, 0777) == -1 && errno != EEXIST)
+    {
+        fprintf(stderr, "Failed to create the result cache directory '%s'.\n", cacheDirectory);
+        return false;
+    }
+
+    char* entryPath = ResultCacheEntryPath(cacheDirectory, key, RESULT_CACHE_ENTRY_EXTENSION);
+    char* temporaryPath = entryPath != NULL ? ResultCacheTemporaryPath(entryPath) : NULL;
+    FILE* entry = temporaryPath != NULL ? fopen(temporaryPath, "wb") : NULL;
+    if (entry == NULL)
+    {
+        free(entryPath);
+        free(temporaryPath);
+        return false;
+    }
+
+    // The entry is the magic, the number of files, and then the name and contents of each file.
+    bool succeeded = fwrite(RESULT_CACHE_MAGIC, 4, 1, entry) == 1 && WriteInteger(entry, (uint64_t)fileCount);
+    for (int i = 0; succeeded && i < fileCount; i++)
+    {
+        FILE* input = fopen(fileNames[i], "rb");
+        struct stat fileStats;
+        succeeded = input != NULL && fstat(fileno(input), &fileStats) == 0 &&
+                    WriteInteger(entry, strlen(fileNames[i])) &&
+                    fwrite(fileNames[i], 1, strlen(fileNames[i]), entry) == strlen(fileNames[i]) &&
+                    WriteInteger(entry, (uint64_t)fileStats.st_size) &&
+                    CopyBytes(input, entry, (uint64_t)fileStats.st_size);
+        if (input != NULL)
+            fclose(input);
+    }
+    succeeded = (fclose(entry) == 0) && succeeded;
+
+    // Publish the entry in one step. If another worker stored the same key meanwhile, its entry is just replaced by
+    // an identical one.
+    succeeded = succeeded && rename(temporaryPath, entryPath) == 0;
+    if (!succeeded)
+        remove(temporaryPath);
+
+    free(entryPath);
+    free(temporaryPath);
+
+    ResultCacheEvict(cacheDirectory, limitBytes);
+    return succeeded;
+}
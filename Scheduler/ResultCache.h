@@ -0,0 +1,66 @@
+/**
+ * @file ResultCache.h
+ */
+
+#pragma once
+
+#include "ScheduleFile.h"
+#include <stdbool.h>
+
+/**
+ * The number of bytes in a result cache key.
+ */
+#define RESULT_CACHE_KEY_SIZE 32
+
+/**
+ * Identifies the results of one simulation: a SHA-256 hash of everything that decides what the simulation outputs.
+ */
+typedef struct tagResultCacheKey
+{
+    unsigned char bytes[RESULT_CACHE_KEY_SIZE];
+} ResultCacheKey;
+
+/**
+ * @brief Computes the cache key for a simulation.
+ *
+ * The key covers the scheduler type, run length and quantum (only for Round-Robin, the one scheduler it affects),
+ * and every process in order, since the processes are already sorted by arrival. Any other settings that change the
+ * output files, such as the index stride, have to be passed in as well.
+ *
+ * @param inputData The schedule that is simulated.
+ * @param settings Other settings that change the output files.
+ * @param settingCount The number of settings.
+ * @param key Outputs the key.
+ */
+void ResultCacheComputeKey(ScheduleData* inputData, const unsigned int* settings, int settingCount,
+                           ResultCacheKey* key);
+
+/**
+ * @brief Serves a simulation's output files from the cache.
+ *
+ * If the cache has an entry for the key holding exactly the given files, each file is restored by writing a temporary
+ * file and renaming it into place, and the entry is marked as recently used.
+ *
+ * @param cacheDirectory The directory the cache is kept in.
+ * @param key The key of the simulation.
+ * @param fileNames The names of the output files to restore.
+ * @param fileCount The number of output files.
+ * @return True if the files were restored from the cache, otherwise false.
+ */
+bool ResultCacheFetch(const char* cacheDirectory, const ResultCacheKey* key, const char** fileNames, int fileCount);
+
+/**
+ * @brief Stores a simulation's output files in the cache.
+ *
+ * The entry is written to a temporary file and renamed into place, so workers sharing the cache directory never see
+ * a partial entry. Afterwards, the least recently used entries are removed until the cache is within its size limit.
+ *
+ * @param cacheDirectory The directory the cache is kept in. It is created if it does not exist.
+ * @param key The key of the simulation.
+ * @param fileNames The names of the output files to store.
+ * @param fileCount The number of output files.
+ * @param limitBytes The total size that the entries in the cache may take up.
+ * @return True if the files were stored, otherwise false.
+ */
+bool ResultCacheStore(const char* cacheDirectory, const ResultCacheKey* key, const char** fileNames, int fileCount,
+                      unsigned long long limitBytes);
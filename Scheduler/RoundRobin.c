@@ -4,13 +4,13 @@
 
 #include "RoundRobin.h"
 #include "ScheduleFile.h"
+#include "Log.h"
 #include <CLib/Vector.h>
 #include <stdlib.h>
 #include <stdio.h>
-void RunRRProcess (ScheduleData* inputData){
-	FILE *out = fopen("processes.out", "w");
+void RunRRProcess (ScheduleData* inputData, Trace* trace){
 	int numProc = VectorCount(inputData->processes);
-	fprintf(out, "%d processes\nUsing Round Robin\n", numProc);
+	TracePrintf(trace, "%d processes\nUsing Round Robin\n", numProc);
 
 	/*
 	* How-to:
@@ -18,54 +18,81 @@ void RunRRProcess (ScheduleData* inputData){
 	*/
 
 	LinkedList* list;
-	InputProcess ListofProcesses[numProc];
 	int Head, clock, quantum, currentQuantum;
 	Head = clock = 0;
 	currentQuantum = quantum = inputData->timeQuantum;
 	bool running = false;
 
-	fprintf(out, "Quantum %d\n\n", quantum);
+	TracePrintf(trace, "Quantum %d\n\n", quantum);
+	LOG_DEBUG(LogRR, "Starting Round Robin with %d processes and quantum %d, running for %d", numProc, quantum,
+		inputData->runLength);
 
+	// The working copy of the processes stays on the stack for small schedules, and moves to the heap for big ones
+	// that would overflow it.
+	InputProcessSmallVector processes;
+	InputProcessSmallVectorCreate(&processes);
+	if (!InputProcessSmallVectorReserve(numProc, &processes)) {
+		LOG_ERROR(LogRR, "Could not allocate %d processes", numProc);
+		return;
+	}
 	for(int i = 0; i < numProc; i++) {
-		ListofProcesses[i] = (*(InputProcess*)VectorGet(i, inputData->processes));
+		InputProcessSmallVectorPush(VectorGet(i, inputData->processes), &processes);
 	}
+	InputProcess* ListofProcesses = InputProcessSmallVectorData(&processes);
+
+	// The ready list and the arrivals wheel live in one arena, so their nodes are handed out from a few large blocks
+	// rather than one malloc each, and all freed together at the end.
+	Arena* arena;
+	ArenaCreate(0, &arena);
+	Allocator allocator;
+	ArenaGetAllocator(arena, &allocator);
+
+	LinkedListCreateWithAllocator(sizeof(int), &allocator, &list);
 
-	LinkedListCreate(sizeof(int), &list);
+	// Each arrival is a timer on the wheel, so a tick only touches the processes that actually arrive on it.
+	TimingWheel* arrivals;
+	TimingWheelCreateWithAllocator(sizeof(int), 0, &allocator, &arrivals);
+	for (int i = 0; i < numProc; i++) {
+		TimingWheelSchedule(&i, ListofProcesses[i].arrivalTime, NULL, arrivals);
+	}
 
 	for (; clock < inputData->runLength+1; ++clock) {
 		// Check for new arrivals
-		for (int i = 0; i < numProc; ++i) {
-			if (ListofProcesses[i].arrivalTime == clock) {
-				int j = 0;
-				// Check to see if the new arrival should be inserted inside the linked list
-				for (; j < LinkedListCount(list); j++)
-				{
-					if(i < *(int*)LinkedListGet(j, list)) {
-						LinkedListInsert(&i, j, list);
-						break;
-					}
-				}
-				// Check to see if the new arrival should be inserted at the tail
-				if(j == LinkedListCount(list)) {
-					LinkedListPush(&i, list);
-				}
-				// Check to see if Head should be incremented to point to the same node in the list
-				if(Head >= j && LinkedListCount(list) > 1) {
-					++Head;
+		int i;
+		TimingWheelAdvance(clock, arrivals);
+		while (TimingWheelPopExpired(&i, NULL, arrivals)) {
+			int j = 0;
+			// Check to see if the new arrival should be inserted inside the linked list
+			for (; j < LinkedListCount(list); j++)
+			{
+				if(i < *(int*)LinkedListGet(j, list)) {
+					LinkedListInsert(&i, j, list);
+					break;
 				}
-				fprintf(out, "Time %d: %s arrived\n", clock, ListofProcesses[i].processName);
 			}
+			// Check to see if the new arrival should be inserted at the tail
+			if(j == LinkedListCount(list)) {
+				LinkedListPush(&i, list);
+			}
+			// Check to see if Head should be incremented to point to the same node in the list
+			if(Head >= j && LinkedListCount(list) > 1) {
+				++Head;
+			}
+			TraceArrived(clock, ListofProcesses[i].processName, trace);
 		}
 		if(running) {
 			// Check if the current process just finished
 			if (ListofProcesses[*(int *)LinkedListGet(Head, list)].remainingTime == 0) {
-				fprintf(out, "Time %d: %s finished\n", clock, ListofProcesses[*(int *)LinkedListGet(Head, list)].processName);
+				TraceFinished(clock, ListofProcesses[*(int *)LinkedListGet(Head, list)].processName, trace);
 				LinkedListRemove(Head, list);
 				running = false;
 				currentQuantum = quantum;
 			}
 			// Check if we've reached exceeded the time quantum
 			else if(currentQuantum == 0) {
+				LOG_TRACE(LogRR, "Time %d: %s used up its quantum with %d left", clock,
+					ListofProcesses[*(int *)LinkedListGet(Head, list)].processName,
+					ListofProcesses[*(int *)LinkedListGet(Head, list)].remainingTime);
 				running = false;
 				currentQuantum = quantum;
 				++Head;
@@ -86,11 +113,11 @@ void RunRRProcess (ScheduleData* inputData){
 		if (Head < LinkedListCount(list)) {
 			// Check if we have a process running, or select a new process
 			if (!running) {
-				fprintf(
-					out, "Time %d: %s selected (burst %d)\n",
+				TraceSelected(
 					clock,
 					ListofProcesses[*(int *)LinkedListGet(Head, list)].processName,
-					ListofProcesses[*(int *)LinkedListGet(Head, list)].remainingTime
+					ListofProcesses[*(int *)LinkedListGet(Head, list)].remainingTime,
+					trace
 				);
 				running = true;
 			}
@@ -110,15 +137,19 @@ void RunRRProcess (ScheduleData* inputData){
 		}
 		// If there is no available process and we have clock time left, we are Idle
 		else {
-			fprintf(out, "Time %d: IDLE\n", clock);
+			TraceIdle(clock, trace);
 		}
+
+		// Count the tick in the utilization timeline, if there is one
+		TraceTick(clock, Head < LinkedListCount(list), LinkedListCount(list), trace);
 	}
 
 	// Show results
-	fprintf(out, "Finished at time %d\n\n", clock);
+	LOG_DEBUG(LogRR, "Finished at time %d with %d processes still ready", clock, LinkedListCount(list));
+	TracePrintf(trace, "Finished at time %d\n\n", clock);
 	for (int i = 0; i < numProc; ++i) {
-		fprintf(
-			out,
+		TracePrintf(
+			trace,
 			"%s wait %d turnaround %d\n",
 			ListofProcesses[i].processName,
 			ListofProcesses[i].waitingTime,
@@ -126,6 +157,10 @@ void RunRRProcess (ScheduleData* inputData){
 		);
 	}
 
-	fclose(out);
+	// Everything the containers allocated came from the arena, so destroying it frees them all at once.
+	ArenaDestroy(&arena);
+	// The trace holds on to process names from this function until it is flushed.
+	TraceFlush(trace);
+	InputProcessSmallVectorDestroy(&processes);
   return;
 }
\ No newline at end of file
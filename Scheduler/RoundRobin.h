@@ -6,6 +6,7 @@
 #define SCHEDULER_ROUNDROBIN_H
 
 #include "ScheduleFile.h"
+#include "Trace.h"
 
-void RunRRProcess (ScheduleData* inputData);
+void RunRRProcess (ScheduleData* inputData, Trace* trace);
 //SCHEDULER_ROUNDROBIN_H
@@ -4,13 +4,14 @@
 
 #include "SJF.h"
 #include "ScheduleFile.h"
+#include "Log.h"
 #include <CLib/Vector.h>
 #include <stdlib.h>
 #include <stdio.h>
-void RunPreemptiveSJFProcess (ScheduleData* inputData){
-	FILE *out = fopen("processes.out", "w");
+void RunPreemptiveSJFProcess (ScheduleData* inputData, Trace* trace){
 	int numProc = VectorCount(inputData->processes);
-	fprintf(out, "%d processes\nUsing Shortest Job First (Pre)\n\n", numProc);
+	TracePrintf(trace, "%d processes\nUsing Shortest Job First (Pre)\n\n", numProc);
+	LOG_DEBUG(LogSJF, "Starting Shortest Job First with %d processes, running for %d", numProc, inputData->runLength);
 
 	/*
 	* How-to:
@@ -18,24 +19,46 @@ void RunPreemptiveSJFProcess (ScheduleData* inputData){
 	*/
 
 	LinkedList* list;
-	InputProcess listofProcesses[numProc];
 	int clock, quantum, currentQuantum;
 	clock = 0;
 	currentQuantum = quantum = inputData->timeQuantum;
 	bool running = false;
 
+	// The working copy of the processes stays on the stack for small schedules, and moves to the heap for big ones
+	// that would overflow it.
+	InputProcessSmallVector processes;
+	InputProcessSmallVectorCreate(&processes);
+	if (!InputProcessSmallVectorReserve(numProc, &processes)) {
+		LOG_ERROR(LogSJF, "Could not allocate %d processes", numProc);
+		return;
+	}
 	for(int i = 0; i < numProc; i++) {
-		listofProcesses[i] = (*(InputProcess*)VectorGet(i, inputData->processes));
+		InputProcessSmallVectorPush(VectorGet(i, inputData->processes), &processes);
 	}
+	InputProcess* listofProcesses = InputProcessSmallVectorData(&processes);
+
+	// The ready list and the arrivals wheel live in one arena, so their nodes are handed out from a few large blocks
+	// rather than one malloc each, and all freed together at the end.
+	Arena* arena;
+	ArenaCreate(0, &arena);
+	Allocator allocator;
+	ArenaGetAllocator(arena, &allocator);
 
-	LinkedListCreate(sizeof(int), &list);
+	LinkedListCreateWithAllocator(sizeof(int), &allocator, &list);
+
+	// Each arrival is a timer on the wheel, so a tick only touches the processes that actually arrive on it.
+	TimingWheel* arrivals;
+	TimingWheelCreateWithAllocator(sizeof(int), 0, &allocator, &arrivals);
+	for (int i = 0; i < numProc; i++) {
+		TimingWheelSchedule(&i, listofProcesses[i].arrivalTime, NULL, arrivals);
+	}
 
 	for (; clock < inputData->runLength+1; ++clock) {
 
 		if(running) {
 			// Check if the current process just finished
 			if (listofProcesses[*(int *)LinkedListGet(0, list)].remainingTime == 0) {
-				fprintf(out, "Time %d: %s finished\n", clock, listofProcesses[*(int *)LinkedListGet(0, list)].processName);
+				TraceFinished(clock, listofProcesses[*(int *)LinkedListGet(0, list)].processName, trace);
 				LinkedListRemove(0, list);
 				running = false;
 				currentQuantum = quantum;
@@ -43,27 +66,30 @@ void RunPreemptiveSJFProcess (ScheduleData* inputData){
 		}
 
 		// Check for new arrivals
-		for (int i = 0; i < numProc; ++i) {
-			if (listofProcesses[i].arrivalTime == clock) {
-				int j = 0;
-				// Check to see if the new arrival should be inserted inside the linked list
-				for (; j < LinkedListCount(list); j++)
-				{
-					if(listofProcesses[i].remainingTime < listofProcesses[*(int*)LinkedListGet(j, list)].remainingTime) {
-						LinkedListInsert(&i, j, list);
-						// no longer running the current process because a new one has higher priority
-						if(j == 0) {
-							running = false;
-						}
-						break;
+		int i;
+		TimingWheelAdvance(clock, arrivals);
+		while (TimingWheelPopExpired(&i, NULL, arrivals)) {
+			int j = 0;
+			// Check to see if the new arrival should be inserted inside the linked list
+			for (; j < LinkedListCount(list); j++)
+			{
+				if(listofProcesses[i].remainingTime < listofProcesses[*(int*)LinkedListGet(j, list)].remainingTime) {
+					LinkedListInsert(&i, j, list);
+					// no longer running the current process because a new one has higher priority
+					if(j == 0) {
+						if (running)
+							LOG_TRACE(LogSJF, "Time %d: %s preempts %s", clock, listofProcesses[i].processName,
+								listofProcesses[*(int*)LinkedListGet(1, list)].processName);
+						running = false;
 					}
+					break;
 				}
-				// Check to see if the new arrival should be inserted at the tail
-				if(j == LinkedListCount(list)) {
-					LinkedListPush(&i, list);
-				}
-				fprintf(out, "Time %d: %s arrived\n", clock, listofProcesses[i].processName);
 			}
+			// Check to see if the new arrival should be inserted at the tail
+			if(j == LinkedListCount(list)) {
+				LinkedListPush(&i, list);
+			}
+			TraceArrived(clock, listofProcesses[i].processName, trace);
 		}
 
 		// Did we run out of time?
@@ -75,11 +101,11 @@ void RunPreemptiveSJFProcess (ScheduleData* inputData){
 		if (LinkedListCount(list) > 0) {
 			// Check if we have a process running, or select a new process
 			if (!running) {
-				fprintf(
-					out, "Time %d: %s selected (burst %d)\n",
+				TraceSelected(
 					clock,
 					listofProcesses[*(int *)LinkedListGet(0, list)].processName,
-					listofProcesses[*(int *)LinkedListGet(0, list)].remainingTime
+					listofProcesses[*(int *)LinkedListGet(0, list)].remainingTime,
+					trace
 				);
 				running = true;
 			}
@@ -99,15 +125,19 @@ void RunPreemptiveSJFProcess (ScheduleData* inputData){
 		}
 		// If there is no available process and we have clock time left, we are Idle
 		else {
-			fprintf(out, "Time %d: IDLE\n", clock);
+			TraceIdle(clock, trace);
 		}
+
+		// Count the tick in the utilization timeline, if there is one
+		TraceTick(clock, LinkedListCount(list) > 0, LinkedListCount(list), trace);
 	}
 
 	// Show results
-	fprintf(out, "Finished at time %d\n\n", clock);
+	LOG_DEBUG(LogSJF, "Finished at time %d with %d processes still ready", clock, LinkedListCount(list));
+	TracePrintf(trace, "Finished at time %d\n\n", clock);
 	for (int i = 0; i < numProc; ++i) {
-		fprintf(
-			out,
+		TracePrintf(
+			trace,
 			"%s wait %d turnaround %d\n",
 			listofProcesses[i].processName,
 			listofProcesses[i].waitingTime,
@@ -115,6 +145,10 @@ void RunPreemptiveSJFProcess (ScheduleData* inputData){
 		);
 	}
 
-	fclose(out);
+	// Everything the containers allocated came from the arena, so destroying it frees them all at once.
+	ArenaDestroy(&arena);
+	// The trace holds on to process names from this function until it is flushed.
+	TraceFlush(trace);
+	InputProcessSmallVectorDestroy(&processes);
   return;
 }
@@ -6,5 +6,6 @@
 #define SCHEDULER_SJF_H
 
 #include "ScheduleFile.h"
+#include "Trace.h"
 
-void RunPreemptiveSJFProcess (ScheduleData* inputData);
+void RunPreemptiveSJFProcess (ScheduleData* inputData, Trace* trace);
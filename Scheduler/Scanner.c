@@ -2,11 +2,50 @@
  * @file Scanner.c
  */
 
+#define _GNU_SOURCE
+
 #include "Scanner.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
-#include <ctype.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SCANNER_HAS_SIMD 1
+#endif
+
+/**
+ * The type of every byte. Only ASCII letters, digits and whitespace are anything other than symbols, as in the C
+ * locale, so the table never depends on the locale the scanner is run in.
+ */
+static const unsigned char ScannerCharTypes[256] =
+{
+    [0 ... '\t' - 1] = Symbol,
+    ['\t' ... '\r'] = Whitespace,
+    ['\r' + 1 ... ' ' - 1] = Symbol,
+    [' '] = Whitespace,
+    ['!' ... '/'] = Symbol,
+    ['0' ... '9'] = Digit,
+    [':' ... '@'] = Symbol,
+    ['A' ... 'Z'] = Alpha,
+    ['[' ... '`'] = Symbol,
+    ['a' ... 'z'] = Alpha,
+    ['{' ... 255] = Symbol
+};
+
+#define SCANNER_IS_ALNUM(c) (ScannerCharTypes[(unsigned char)(c)] <= Digit)
+
+/**
+ * Files smaller than this are read into the scanner's buffer rather than mapped, since setting up and tearing down a
+ * mapping costs more than copying a few pages.
+ */
+#define SCANNER_MAP_MIN_BYTES 65536
 
 /**
  * Internal representation of a Scanner.
@@ -14,19 +53,146 @@
 typedef struct tagScanner
 {
     /**
-     * Represents the raw contents of the file.
+     * Represents the raw contents of the file. This is either a read-only mapping of the file or a heap buffer, and
+     * is not null terminated.
      */
     char* fileContents;
     /**
      * The length of the file, in bytes.
      */
-    unsigned int fileLength;
+    size_t fileLength;
     /**
      * The current index position in the file that the scanner is on.
      */
-    unsigned int currentPos;
+    size_t currentPos;
+    /**
+     * True if fileContents is a mapping of the file, which has to be unmapped rather than freed.
+     */
+    bool mapped;
+    /**
+     * A buffer that files which are not mapped are read into. It is kept from one file to the next, and only grows,
+     * so a scanner that is reused does not allocate once it has seen its largest file.
+     */
+    char* readBuffer;
+    /**
+     * The size of the read buffer, in bytes.
+     */
+    size_t readBufferCapacity;
 } Scanner;
 
+/**
+ * Finds the length of the run of letters and digits at the start of some text.
+ */
+static size_t ScannerSpanAlnumScalar(const char* text, size_t length)
+{
+    size_t position = 0;
+    while (position < length && SCANNER_IS_ALNUM(text[position]))
+        position++;
+    return position;
+}
+
+#ifdef SCANNER_HAS_SIMD
+
+/**
+ * Checks 16 bytes at once, 16 at a time, and finishes off the last few one at a time.
+ */
+__attribute__((target("sse2")))
+static size_t ScannerSpanAlnumSSE2(const char* text, size_t length)
+{
+    size_t position = 0;
+    while (length - position >= 16)
+    {
+        __m128i bytes = _mm_loadu_si128((const __m128i*)(text + position));
+
+        // Folding the case makes letters a single range. Bytes above 0x7F are negative, so they fall outside both.
+        __m128i folded = _mm_or_si128(bytes, _mm_set1_epi8(0x20));
+        __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(folded, _mm_set1_epi8('a' - 1)),
+                                        _mm_cmplt_epi8(folded, _mm_set1_epi8('z' + 1)));
+        __m128i digits = _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8('0' - 1)),
+                                       _mm_cmplt_epi8(bytes, _mm_set1_epi8('9' + 1)));
+
+        unsigned int others = ~(unsigned int)_mm_movemask_epi8(_mm_or_si128(letters, digits)) & 0xFFFFu;
+        if (others != 0)
+            return position + (size_t)__builtin_ctz(others);
+        position += 16;
+    }
+
+    return position + ScannerSpanAlnumScalar(text + position, length - position);
+}
+
+/**
+ * Checks 32 bytes at a time, and finishes off the rest with SSE2.
+ */
+__attribute__((target("avx2")))
+static size_t ScannerSpanAlnumAVX2(const char* text, size_t length)
+{
+    size_t position = 0;
+    while (length - position >= 32)
+    {
+        __m256i bytes = _mm256_loadu_si256((const __m256i*)(text + position));
+
+        __m256i folded = _mm256_or_si256(bytes, _mm256_set1_epi8(0x20));
+        __m256i letters = _mm256_and_si256(_mm256_cmpgt_epi8(folded, _mm256_set1_epi8('a' - 1)),
+                                           _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), folded));
+        __m256i digits = _mm256_and_si256(_mm256_cmpgt_epi8(bytes, _mm256_set1_epi8('0' - 1)),
+                                          _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), bytes));
+
+        unsigned int others = ~(unsigned int)_mm256_movemask_epi8(_mm256_or_si256(letters, digits));
+        if (others != 0)
+            return position + (size_t)__builtin_ctz(others);
+        position += 32;
+    }
+
+    return position + ScannerSpanAlnumSSE2(text + position, length - position);
+}
+
+#endif
+
+/**
+ * The widest way of finding the end of a word that the CPU supports. This is picked once, when the program starts.
+ */
+static size_t (*ScannerSpanAlnum)(const char* text, size_t length) = ScannerSpanAlnumScalar;
+
+#ifdef SCANNER_HAS_SIMD
+__attribute__((constructor))
+static void ScannerSelectSpanAlnum()
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        ScannerSpanAlnum = ScannerSpanAlnumAVX2;
+    else if (__builtin_cpu_supports("sse2"))
+        ScannerSpanAlnum = ScannerSpanAlnumSSE2;
+}
+#endif
+
+/**
+ * Reads up to 8 digits at once out of 8 bytes of text, returning how many of the bytes, from the first, were digits.
+ * The digits are checked and combined in a 64 bit register, rather than one byte at a time.
+ */
+static unsigned int ScannerParseEightDigits(const char* text, uint64_t* value)
+{
+    uint64_t chunk;
+    memcpy(&chunk, text, sizeof(chunk));
+
+    // Digits become the bytes 0 to 9. Any other byte has a bit set in its top half, or reaches 0x10 when 6 is added.
+    uint64_t values = chunk ^ 0x3030303030303030ull;
+    uint64_t nonDigits = (values & 0xF0F0F0F0F0F0F0F0ull) |
+                         (((values & 0x0F0F0F0F0F0F0F0Full) + 0x0606060606060606ull) & 0x1010101010101010ull);
+    unsigned int digitCount = nonDigits == 0 ? 8 : (unsigned int)__builtin_ctzll(nonDigits) / 8;
+    if (digitCount == 0)
+        return 0;
+
+    // Move the digits to the top of the register, so the bytes below them are zeros that add nothing, then combine
+    // pairs of digits, pairs of those, and finally the two halves.
+    values <<= 8 * (8 - digitCount);
+    values = (values * 10) + (values >> 8);
+    values = (((values & 0x000000FF000000FFull) * (100 + (1000000ull << 32))) +
+              (((values >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32;
+
+    *value = values;
+    return digitCount;
+}
+
 bool ScannerCreate(Scanner** scan)
 {
     (*scan) = calloc(1, sizeof(Scanner));
@@ -36,87 +202,189 @@ bool ScannerCreate(Scanner** scan)
     return true;
 }
 
+void ScannerReset(Scanner* scan)
+{
+    // Only a mapping is released. The read buffer is kept for the next file, and a client's text is the client's.
+    if (scan->mapped)
+        munmap(scan->fileContents, scan->fileLength);
+
+    scan->fileContents = NULL;
+    scan->fileLength = 0;
+    scan->currentPos = 0;
+    scan->mapped = false;
+}
+
 void ScannerDestroy(Scanner** scan)
 {
-    free((*scan)->fileContents);
+    ScannerReset(*scan);
+    free((*scan)->readBuffer);
     free(*scan);
     *scan = NULL;
 }
 
 bool ScannerReadFile(const char* fileName, Scanner* scan)
 {
+    // Open the file.
+    int file = open(fileName, O_RDONLY | O_CLOEXEC);
+    if (file == -1)
+    {
+        fprintf(stderr, "Failed to open the '%s' file. Are you sure it's in the same directory "
+                "as the executable?\n", fileName);
+        return false;
+    }
+
     // Get file statistics.
     struct stat fileStats;
-    if (stat(fileName, &fileStats) == -1)
+    if (fstat(file, &fileStats) == -1)
     {
         fprintf(stderr, "Failed to get file statistics.\n");
+        close(file);
         return false;
     }
 
-    // Get the length of the file.
-    scan->fileLength = (unsigned int)fileStats.st_size;
+    ScannerReset(scan);
+    scan->fileLength = (size_t)fileStats.st_size;
 
-    // Open the processes.in file.
-    FILE* file = fopen(fileName, "r");
-    if (file == NULL)
+    // Scan larger files straight out of the page cache. The pages are faulted in up front and read ahead, since the
+    // scanner goes through them once, from start to end.
+    if (scan->fileLength >= SCANNER_MAP_MIN_BYTES)
     {
-        fprintf(stderr, "Failed to open the 'processes.in' file. Are you sure it's in the same directory "
-                "as the executable?\n");
-        return false;
+        void* mapping = mmap(NULL, scan->fileLength, PROT_READ, MAP_PRIVATE | MAP_POPULATE, file, 0);
+        if (mapping != MAP_FAILED)
+        {
+            madvise(mapping, scan->fileLength, MADV_SEQUENTIAL);
+            scan->fileContents = mapping;
+            scan->mapped = true;
+            close(file);
+            return true;
+        }
     }
 
-    // Read the contents of the file.
-    scan->fileContents = calloc(scan->fileLength + 1, sizeof(char));
-    unsigned int numBytesRead = fread(scan->fileContents, sizeof(char), scan->fileLength, file);
+    // Small files, and files that cannot be mapped at all, like pipes, are read into the buffer instead.
+    if (scan->readBufferCapacity < scan->fileLength || scan->readBuffer == NULL)
+    {
+        size_t capacity = scan->fileLength > 0 ? scan->fileLength : 1;
+        char* buffer = realloc(scan->readBuffer, capacity);
+        if (buffer == NULL)
+        {
+            fprintf(stderr, "Failed to allocate memory for the contents of the file.\n");
+            close(file);
+            scan->fileLength = 0;
+            return false;
+        }
+        scan->readBuffer = buffer;
+        scan->readBufferCapacity = capacity;
+    }
+    scan->fileContents = scan->readBuffer;
 
-    fclose(file);
+    size_t numBytesRead = 0;
+    while (numBytesRead < scan->fileLength)
+    {
+        ssize_t result = read(file, scan->fileContents + numBytesRead, scan->fileLength - numBytesRead);
+        if (result <= 0)
+            break;
+        numBytesRead += (size_t)result;
+    }
+
+    close(file);
 
     if (numBytesRead < scan->fileLength)
     {
         fprintf(stderr, "Failed to read the entire contents of the file.\n");
-        free(scan->fileContents);
-        scan->fileContents = NULL;
+        ScannerReset(scan);
         return false;
     }
 
-    // Ensure fileContents is a C String.
-    scan->fileContents[scan->fileLength] = '\0';
+    return true;
+}
+
+bool ScannerReadBuffer(const char* buffer, size_t length, Scanner* scan)
+{
+    // The scanner only ever reads its contents, so it can scan the client's text without copying it.
+    ScannerReset(scan);
+    scan->fileContents = (char*)buffer;
+    scan->fileLength = length;
 
     return true;
 }
 
+void ScannerGetContents(const char** contents, size_t* length, Scanner* scan)
+{
+    *contents = scan->fileContents;
+    *length = scan->fileLength;
+}
+
 void ScannerReadNextString(char** strStart, unsigned int* strLength, Scanner* scan)
 {
     // Set teh start position of the string.
     unsigned int length = 0;
     *strStart = scan->fileContents + scan->currentPos;
 
-    // Move the scanner forward until a whitespace character is found, or the end of the file is reached.
-    while (!ScannerIsAtEnd(scan) && isalnum(scan->fileContents[scan->currentPos]))
+    // Move the scanner forward until a character other than a letter or digit is found, or the end of the file is
+    // reached. This checks as many characters at once as the CPU can.
+    length = (unsigned int)ScannerSpanAlnum(*strStart, scan->fileLength - scan->currentPos);
+    scan->currentPos += length;
+
+    // Set the end position to where the scanner is now.
+    *strLength = length;
+}
+
+void ScannerReadQuotedString(char** strStart, unsigned int* strLength, Scanner* scan)
+{
+    // Skip over the opening quote.
+    ScannerMoveForward(scan);
+
+    unsigned int length = 0;
+    *strStart = scan->fileContents + scan->currentPos;
+
+    // A quoted string cannot span lines, so an unterminated string ends with its line.
+    while (!ScannerIsAtEnd(scan) && scan->fileContents[scan->currentPos] != '"' &&
+           scan->fileContents[scan->currentPos] != '\n')
     {
         length++;
         ScannerMoveForward(scan);
     }
 
-    // Set the end position to where the scanner is now.
+    // Skip over the closing quote.
+    if (!ScannerIsAtEnd(scan) && scan->fileContents[scan->currentPos] == '"')
+        ScannerMoveForward(scan);
+
     *strLength = length;
 }
 
 int ScannerReadNextInteger(Scanner* scan)
 {
-    int numberStartPos = scan->currentPos;
+    // Convert the digits starting at the current position into a number, stopping at the first non digit or at the
+    // end of the file, since the contents are not null terminated. Numbers too large to hold saturate, like strtol.
+    long result = 0;
+    static const long powersOfTen[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // Take the digits 8 at a time while there are at least 8 bytes left to look at.
+    while (scan->fileLength - scan->currentPos >= 8)
+    {
+        uint64_t digits;
+        unsigned int digitCount = ScannerParseEightDigits(scan->fileContents + scan->currentPos, &digits);
+        if (digitCount == 0)
+            break;
 
-    // Convert the portion of teh file data from start position to end position into a number.
-    // The nice thing about strtol is it will continue parsing digits until a non digit is found.
-    // It then outputs a pointer to the section of the string where the number ends.
-    char* numberEndPos;
-    int result = (int)strtol(scan->fileContents + numberStartPos, &numberEndPos, 10);
+        long scale = powersOfTen[digitCount];
+        result = result > (LONG_MAX - (long)digits) / scale ? LONG_MAX : result * scale + (long)digits;
+        scan->currentPos += digitCount;
+        if (digitCount < 8)
+            return (int)result;
+    }
+#endif
 
-    // Update the position of the scanner. Make it point to the character (or end of file) directly after the last
-    // character of the number.
-    scan->currentPos = (unsigned int)(numberEndPos - scan->fileContents);
+    while (!ScannerIsAtEnd(scan) && ScannerCharTypes[(unsigned char)scan->fileContents[scan->currentPos]] == Digit)
+    {
+        int digit = scan->fileContents[scan->currentPos] - '0';
+        result = result > (LONG_MAX - digit) / 10 ? LONG_MAX : result * 10 + digit;
+        scan->currentPos++;
+    }
 
-    return result;
+    // The scanner now points to the character (or end of file) directly after the last character of the number.
+    return (int)result;
 }
 
 void ScannerMoveForward(Scanner* scan)
@@ -129,10 +397,16 @@ void ScannerMoveForward(Scanner* scan)
 
 void ScannerMoveToNextLine(Scanner* scan)
 {
-    while (!ScannerIsAtEnd(scan) && scan->fileContents[scan->currentPos] != '\n')
-    {
-        ScannerMoveForward(scan);
-    }
+    const char* lineEnd = memchr(scan->fileContents + scan->currentPos, '\n', scan->fileLength - scan->currentPos);
+    scan->currentPos = lineEnd != NULL ? (size_t)(lineEnd - scan->fileContents) : scan->fileLength;
+}
+
+void ScannerSkipWhitespace(Scanner* scan)
+{
+    // Runs of whitespace are short, a space or a line break between tokens, so a table lookup per character is
+    // quicker here than setting up a vector compare.
+    while (!ScannerIsAtEnd(scan) && ScannerCharTypes[(unsigned char)scan->fileContents[scan->currentPos]] == Whitespace)
+        scan->currentPos++;
 }
 
 CharType ScannerGetCharType(Scanner* scan)
@@ -140,19 +414,14 @@ CharType ScannerGetCharType(Scanner* scan)
     if (ScannerIsAtEnd(scan))
         return EndFile;
 
-    char currentChar = scan->fileContents[scan->currentPos];
-    if (isalpha(currentChar))
-        return Alpha;
-    else if (isdigit(currentChar))
-        return Digit;
-    else if (isspace(currentChar))
-        return Whitespace;
-
-    return Symbol;
+    return (CharType)ScannerCharTypes[(unsigned char)scan->fileContents[scan->currentPos]];
 }
 
 char ScannerGetChar(Scanner* scan)
 {
+    if (ScannerIsAtEnd(scan))
+        return '\0';
+
     return scan->fileContents[scan->currentPos];
 }
 
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 
 /**
  * Represents a scanner, which reads through a file character by character.
@@ -50,6 +51,13 @@ bool ScannerCreate(Scanner **scan);
  */
 void ScannerDestroy(Scanner **scan);
 
+/**
+ * Lets go of whatever the scanner was loaded with, so that it can be loaded with something else. The scanner keeps
+ * the buffer it reads files into, so loading another file of the same size or smaller does not allocate.
+ * @param scan The scanner object to reset.
+ */
+void ScannerReset(Scanner *scan);
+
 /**
  * Reads the contents of a file into the scanner.
  * @param filename The filename to read from.
@@ -58,6 +66,24 @@ void ScannerDestroy(Scanner **scan);
  */
 bool ScannerReadFile(const char *filename, Scanner *scan);
 
+/**
+ * Points the scanner at a block of text, to be scanned as if it were the contents of a file. The text is scanned
+ * where it is rather than copied, so it must stay valid and unchanged for as long as the scanner reads it.
+ * @param buffer The text to scan. It does not need to be null terminated.
+ * @param length The length of the text, in bytes.
+ * @param scan The scanner object to load the text into.
+ * @return True if the operation succeeds, otherwise false.
+ */
+bool ScannerReadBuffer(const char *buffer, size_t length, Scanner *scan);
+
+/**
+ * Gets the whole of the contents the scanner was loaded with, wherever it is in them.
+ * @param contents Receives the contents. They are not null terminated.
+ * @param length Receives the length of the contents, in bytes.
+ * @param scan The scanner to use.
+ */
+void ScannerGetContents(const char **contents, size_t *length, Scanner *scan);
+
 /**
  * @brief Reads the next string from the file.
  *
@@ -69,6 +95,17 @@ bool ScannerReadFile(const char *filename, Scanner *scan);
  */
 void ScannerReadNextString(char **strStart, unsigned int *strLength, Scanner *scan);
 
+/**
+ * @brief Reads the next quoted string from the file.
+ *
+ * Starting with the scanner's current position, which should be a double quote character, reads until the closing
+ * double quote, the end of the line or the end of the file, and stops after the closing quote.
+ * @param strStart Sets a pointer to the first character inside the quotes in the scanner's internal file contents.
+ * @param strLength Outputs the length of the string, not counting the quotes.
+ * @param scan The scanner object to use.
+ */
+void ScannerReadQuotedString(char **strStart, unsigned int *strLength, Scanner *scan);
+
 /**
  * Reads the next integer from the file.
  * @param scan The scanner to use.
@@ -88,6 +125,12 @@ void ScannerMoveForward(Scanner *scan);
  */
 void ScannerMoveToNextLine(Scanner *scan);
 
+/**
+ * Moves the scanner forward past any whitespace, so that it is on the next character that is not whitespace.
+ * @param scan The scanner to move forward.
+ */
+void ScannerSkipWhitespace(Scanner *scan);
+
 /**
  * Gets the type of the current character.
  * @param scan The scanner to use.
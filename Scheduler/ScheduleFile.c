@@ -4,9 +4,43 @@
 
 #include "ScheduleFile.h"
 #include "Lexer.h"
+#include "Log.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <pthread.h>
+#include <unistd.h>
+
+/**
+ * Files are split into chunks for several threads to parse only when each thread gets at least this much of the file.
+ */
+#define PARALLEL_PARSE_MIN_CHUNK_BYTES (1 << 20)
+
+/**
+ * The most threads a file is parsed with.
+ */
+#define PARALLEL_PARSE_MAX_THREADS 64
+
+/**
+ * The length of the shortest possible process line, "process name a arrival 0 burst 0" and its line break, which
+ * bounds how many processes a range of text can hold.
+ */
+#define PROCESS_LINE_MIN_BYTES 33
+
+// The parts of a processes file that ParseScheduleTokens accepts.
+typedef enum tagParseMode
+{
+    // The whole file.
+    ParseWholeFile,
+    // Just the directives before the first process. Parsing stops at the first "process", without reading the line,
+    // and the count from "processcount" is only recorded in processCount, without making the table for the processes.
+    ParseHeader,
+    // Just whole "process" lines, such as the lines of a file that changed, or one chunk of a large file.
+    ParseProcessesOnly
+} ParseMode;
+
+static bool ParseScheduleParallel(const char* text, size_t length, ScheduleData* fileData);
 
 int ProcessArrivalCompareTo(const void* obj1, const void* obj2)
 {
@@ -27,231 +61,802 @@ int ProcessArrivalCompareTo(const void* obj1, const void* obj2)
     return strcmp(process1->processName, process2->processName);
 }
 
+// Reports a problem with the processes file, unless the caller only wants to know whether the tokens parse.
+#define REPORT_PARSE_ERROR(...) do { if (reportErrors) fprintf(stderr, __VA_ARGS__); } while (0)
+
+// Pulls the next token out of the lexer into the given storage, returning NULL at the end of the input.
+static LexerToken* NextToken(Lexer* lexer, LexerToken* token)
+{
+    return LexerNextToken(lexer, token) ? token : NULL;
+}
+
 // Once a process line is identified, this will handle the tokens that make
 // up a process line, returning false if any of the tokens are invalid. The main
-// code should have the currentTokenIndex positioned on "process".
-bool ParseProcess(Vector* tokens, unsigned int* currentTokenIndex, InputProcess* process)
+// code should have just read "process" from the lexer.
+bool ParseProcess(Lexer* lexer, bool reportErrors, InputProcess* process)
 {
+    LexerToken token;
     LexerToken* currentToken;
 
 	process->waitingTime = 0;
 	process->turnaroundTime = 0;
+    process->command = NULL;
 
     for (int i = 0; i < 3; i++)
     {
-        currentToken = VectorGet(++(*currentTokenIndex), tokens);
-        if (strcmp("name", currentToken->strTokenValue) == 0)
+        currentToken = NextToken(lexer, &token);
+        if (currentToken == NULL || currentToken->tokenType != String)
         {
-            // The next token should be a string value representing the name of the process.
-            currentToken = VectorGet(++(*currentTokenIndex), tokens);
-            if (currentToken->tokenType != String)
-            {
-                fprintf(stderr, "Invalid processes file specified. Found an unexpected digit character.\n");
-                return false;
-            }
-
-            strcpy(process->processName, currentToken->strTokenValue);
+            REPORT_PARSE_ERROR("Invalid processes file specified. A 'process' line ended early.\n");
+            return false;
         }
-        else if (strcmp("arrival", currentToken->strTokenValue) == 0)
-        {
-            // The next token should be an integer value representing the arrival time of the process.
-            currentToken = VectorGet(++(*currentTokenIndex), tokens);
-            if (currentToken->tokenType != Number)
-            {
-                fprintf(stderr, "Invalid processes file specified. Found an unexpected alphabetic character.\n");
-                return false;
-            }
 
-            process->arrivalTime = currentToken->numTokenValue;
-        }
-        else if (strcmp("burst", currentToken->strTokenValue) == 0)
+        switch (currentToken->keyword)
         {
-            // The next token should be an integer value representing the burst length of the process.
-            currentToken = VectorGet(++(*currentTokenIndex), tokens);
-            if (currentToken->tokenType != Number)
+            case KeywordName:
             {
-                fprintf(stderr, "Invalid processes file specified. Found an unexpected alphabetic character.\n");
-                return false;
+                // The next token should be a string value representing the name of the process.
+                currentToken = NextToken(lexer, &token);
+                if (currentToken == NULL || currentToken->tokenType != String)
+                {
+                    REPORT_PARSE_ERROR("Invalid processes file specified. Found an unexpected digit character.\n");
+                    return false;
+                }
+
+                // Names longer than the name field are cut short.
+                unsigned int nameLength = currentToken->strTokenLength;
+                if (nameLength > sizeof(process->processName) - 1)
+                    nameLength = sizeof(process->processName) - 1;
+                memcpy(process->processName, currentToken->strTokenValue, nameLength);
+                process->processName[nameLength] = '\0';
+                break;
             }
+            case KeywordArrival:
+                // The next token should be an integer value representing the arrival time of the process.
+                currentToken = NextToken(lexer, &token);
+                if (currentToken == NULL || currentToken->tokenType != Number)
+                {
+                    REPORT_PARSE_ERROR("Invalid processes file specified. Found an unexpected alphabetic character.\n");
+                    return false;
+                }
+
+                process->arrivalTime = currentToken->numTokenValue;
+                break;
+            case KeywordBurst:
+                // The next token should be an integer value representing the burst length of the process.
+                currentToken = NextToken(lexer, &token);
+                if (currentToken == NULL || currentToken->tokenType != Number)
+                {
+                    REPORT_PARSE_ERROR("Invalid processes file specified. Found an unexpected alphabetic character.\n");
+                    return false;
+                }
 
-            process->burstLength = currentToken->numTokenValue;
-			process->remainingTime = currentToken->numTokenValue;
+                process->burstLength = currentToken->numTokenValue;
+                process->remainingTime = currentToken->numTokenValue;
+                break;
+            default:
+                // Unexpected value found.
+                REPORT_PARSE_ERROR("Invalid processes file specified. Found an unexpected value on a 'process' line.\n");
+                return false;
         }
-        else
+    }
+
+    // A process line can end with the command to run when the processes are executed for real.
+    if (LexerPeekToken(lexer, &token) && token.keyword == KeywordCommand)
+    {
+        // The next token should be a string value holding the command line.
+        LexerNextToken(lexer, &token);
+        currentToken = NextToken(lexer, &token);
+        if (currentToken == NULL || currentToken->tokenType != String)
         {
-            // Unexpected value found.
-            fprintf(stderr, "Invalid processes file specified. Found an unexpected value on a 'process' line.\n");
+            REPORT_PARSE_ERROR("Invalid processes file specified. Expected a command after 'command'.\n");
             return false;
         }
+
+        size_t commandLength = currentToken->strTokenLength;
+        process->command = malloc(commandLength + 1);
+        memcpy(process->command, currentToken->strTokenValue, commandLength);
+        process->command[commandLength] = '\0';
     }
 
     return true;
 }
 
-bool ReadScheduleFile(ScheduleData* fileData)
+// Parses the tokens of a processes file into the schedule data, as the lexer pulls them out. Only a whole file
+// reports errors; for just part of a file, anything unexpected is rejected without an error, since the whole file is
+// parsed again then. If stopToken is given, it receives the "end" or "process" token that parsing stopped on, or a
+// token that is NotKeyword if the tokens ran out. If processCount is given, it receives the count from "processcount",
+// or -1 if there is none.
+static bool ParseScheduleTokens(Lexer* lexer, ParseMode mode, ScheduleData* fileData, LexerToken* stopToken,
+                                int* processCount)
 {
-    // Create a lexer for parsing the file.
-    Lexer* lexer;
-    if (!LexerCreate(&lexer))
-    {
-        fprintf(stderr, "Failed to create a lexer.\n");
-        return false;
-    }
-
-    // Read the file into the lexer.
-    if (!LexerParseFile("processes.in", lexer))
-    {
-        fprintf(stderr, "The lexer failed to read the 'processes.in' file. Are you sure it exists in the same folder "
-                "as the executable?\n");
-        LexerDestroy(&lexer);
-        return false;
-    }
-
-    // Get the vector of tokens that were pulled from the file.
-    Vector* tokens = LexerGetTokens(lexer);
+    bool reportErrors = mode == ParseWholeFile;
+    if (stopToken != NULL)
+        stopToken->keyword = NotKeyword;
+    if (processCount != NULL)
+        *processCount = -1;
 
     // Loop through the tokens.
-    unsigned int currentTokenIndex = 0;
+    LexerToken token;
+    LexerToken* currentToken;
     bool readSuccessful = true;
-    while (currentTokenIndex < VectorCount(tokens))
+    while ((currentToken = NextToken(lexer, &token)) != NULL)
     {
-        // Get the current token.
-        LexerToken* currentToken = VectorGet(currentTokenIndex, tokens);
 
         // At this point, the token should always be a string. At this level, we should never find a number token.
         if (currentToken->tokenType != String)
         {
-            fprintf(stderr, "Invalid processes file specified. Found an unexpected digit.\n");
+            REPORT_PARSE_ERROR("Invalid processes file specified. Found an unexpected digit.\n");
+            readSuccessful = false;
+            break;
+        }
+
+        if (mode == ParseProcessesOnly && currentToken->keyword != KeywordProcess &&
+            currentToken->keyword != KeywordEnd)
+        {
             readSuccessful = false;
             break;
         }
 
+        if (mode == ParseHeader && currentToken->keyword == KeywordProcess)
+        {
+            if (stopToken != NULL)
+                *stopToken = *currentToken;
+            break;
+        }
+
         // Do something depending on what the word is.
-        if (strcmp(currentToken->strTokenValue, "processcount") == 0)
+        bool reachedEnd = false;
+        switch (currentToken->keyword)
         {
-            // The next value in the file should be a number representing the number of processes that
-            // are in the file.
-            currentToken = VectorGet(++currentTokenIndex, tokens);
-            if (currentToken->tokenType != Number)
-            {
-                fprintf(stderr, "Invalid processes file specified. Found an unexpected alphabetic character.\n");
-                readSuccessful = false;
+            case KeywordProcessCount:
+                // The next value in the file should be a number representing the number of processes that
+                // are in the file.
+                currentToken = NextToken(lexer, &token);
+                if (currentToken == NULL || currentToken->tokenType != Number)
+                {
+                    REPORT_PARSE_ERROR("Invalid processes file specified. Found an unexpected alphabetic character.\n");
+                    readSuccessful = false;
+                    break;
+                }
+
+                if (processCount != NULL)
+                    *processCount = (int)currentToken->numTokenValue;
+                if (mode == ParseHeader)
+                    break;
+
+                // Using the number of expected processes, initialize the vector of processes to contain them all.
+                // We also provide a compare to callback so this vector can be sorted by the order that processes
+                // arrive.
+                if (!VectorCreate(sizeof(InputProcess), currentToken->numTokenValue, 0, NULL, ProcessArrivalCompareTo,
+                                  &fileData->processes))
+                {
+                    REPORT_PARSE_ERROR("Failed to initialize a vector to contain the input processes.\n");
+                    readSuccessful = false;
+                }
                 break;
-            }
+            case KeywordRunFor:
+                // The next value in the file should be a number representing how long to run the scheduler.
+                currentToken = NextToken(lexer, &token);
+                if (currentToken == NULL || currentToken->tokenType != Number)
+                {
+                    REPORT_PARSE_ERROR("Invalid processes file specified. Found an unexpected alphabetic character.\n");
+                    readSuccessful = false;
+                    break;
+                }
 
-            // Using the number of expected processes, initialize the vector of processes to contain them all.
-            // We also provide a compare to callback so this vector can be sorted by the order that processes
-            // arrive.
-            if (!VectorCreate(sizeof(InputProcess), currentToken->numTokenValue, 0, NULL, ProcessArrivalCompareTo,
-                              &fileData->processes))
+                fileData->runLength = currentToken->numTokenValue;
+                break;
+            case KeywordUse:
+                // The next value in the file should be a string representing the scheduler type we want to use.
+                currentToken = NextToken(lexer, &token);
+                if (currentToken == NULL || currentToken->tokenType != String)
+                {
+                    REPORT_PARSE_ERROR("Invalid processes file specified. Found an unexpected digit.\n");
+                    readSuccessful = false;
+                    break;
+                }
+
+                switch (currentToken->keyword)
+                {
+                    case KeywordFCFS:
+                        fileData->schedulerType = FCFS;
+                        break;
+                    case KeywordSJF:
+                        fileData->schedulerType = ShortestJob;
+                        break;
+                    case KeywordRR:
+                        fileData->schedulerType = RoundRobin;
+                        break;
+                    default:
+                        REPORT_PARSE_ERROR("Invalid processes file specified. Unknown scheduler algorithm specified.\n");
+                        readSuccessful = false;
+                        break;
+                }
+                break;
+            case KeywordQuantum:
+                // The next value in the file should be a number representing the time quantum value.
+                currentToken = NextToken(lexer, &token);
+                if (currentToken == NULL || currentToken->tokenType != Number)
+                {
+                    REPORT_PARSE_ERROR("Invalid processes file specified. Found an unexpected alphabetic character.\n");
+                    readSuccessful = false;
+                    break;
+                }
+
+                fileData->timeQuantum = currentToken->numTokenValue;
+                break;
+            case KeywordProcess:
             {
-                fprintf(stderr, "Failed to initialize a vector to contain the input processes.\n");
-                readSuccessful = false;
+                // The next 6 tokens should all be part of a process.
+                if (fileData->processes == NULL)
+                {
+                    REPORT_PARSE_ERROR("Invalid processes file specified. Found a process before 'processcount'.\n");
+                    readSuccessful = false;
+                    break;
+                }
+
+                // The process is parsed straight into the end of the vector, and taken back off if it is invalid.
+                InputProcess* process = VectorEmplaceBack(fileData->processes);
+                if (process == NULL)
+                {
+                    REPORT_PARSE_ERROR("Failed to make room for another process.\n");
+                    readSuccessful = false;
+                    break;
+                }
+
+                readSuccessful = ParseProcess(lexer, reportErrors, process);
+
+                if (!readSuccessful)
+                {
+                    free(process->command);
+                    VectorResize(VectorCount(fileData->processes) - 1, fileData->processes);
+                }
                 break;
             }
-        }
-        else if (strcmp(currentToken->strTokenValue, "runfor") == 0)
-        {
-            // The next value in the file should be a number representing how long to run the scheduler.
-            currentToken = VectorGet(++currentTokenIndex, tokens);
-            if (currentToken->tokenType != Number)
-            {
-                fprintf(stderr, "Invalid processes file specified. Found an unexpected alphabetic character.\n");
+            case KeywordEnd:
+                // No work needs to be done. We've reached the end of input.
+                reachedEnd = true;
+                if (stopToken != NULL)
+                    *stopToken = *currentToken;
+                break;
+            default:
+                // Unknown value specified.
+                REPORT_PARSE_ERROR("Invalid processes file specified. Found an unexpected string value where a "
+                        "process configuration value was expected.\n");
                 readSuccessful = false;
                 break;
-            }
+        }
+
+        if (!readSuccessful || reachedEnd)
+            break;
+    }
+
+    return readSuccessful;
+}
+
+// Parses a processes file as the lexer reads through it, and sorts the processes by arrival. Large files are split up
+// and parsed by several threads, unless they hold something other than process lines after the first process.
+static bool ParseScheduleLexer(Lexer* lexer, ScheduleData* fileData)
+{
+    const char* text;
+    size_t length;
+    LexerGetText(&text, &length, lexer);
+    if (length >= 2 * PARALLEL_PARSE_MIN_CHUNK_BYTES && ParseScheduleParallel(text, length, fileData))
+        return true;
+
+    fileData->processes = NULL;
+    bool readSuccessful = ParseScheduleTokens(lexer, ParseWholeFile, fileData, NULL, NULL);
+
+    // Finally, with the processes all read in, sort them so earliest arrivals come in first.
+    if (fileData->processes != NULL)
+        VectorSort(fileData->processes);
+
+    return readSuccessful && fileData->processes != NULL;
+}
 
-            fileData->runLength = currentToken->numTokenValue;
+/**
+ * Internal representation of a ScheduleReader.
+ */
+typedef struct tagScheduleReader
+{
+    /**
+     * The lexer that every file is read with. It is reset between files rather than created again.
+     */
+    Lexer* lexer;
+} ScheduleReader;
+
+bool ScheduleReaderCreate(ScheduleReader** reader)
+{
+    *reader = calloc(1, sizeof(ScheduleReader));
+    if (*reader == NULL)
+        return false;
+
+    // Create a lexer for parsing the files.
+    if (!LexerCreate(&(*reader)->lexer))
+    {
+        fprintf(stderr, "Failed to create a lexer.\n");
+        free(*reader);
+        *reader = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+void ScheduleReaderDestroy(ScheduleReader** reader)
+{
+    LexerDestroy(&(*reader)->lexer);
+    free(*reader);
+    *reader = NULL;
+}
+
+bool ReadScheduleFileFrom(const char* fileName, const char* contents, size_t length, ScheduleReader* reader,
+                          ScheduleData* fileData)
+{
+    fileData->processes = NULL;
+
+    // Point the lexer at the file. It is parsed in a single pass as the tokens are pulled out.
+    if (fileName != NULL && !LexerOpenFile(fileName, reader->lexer))
+    {
+        fprintf(stderr, "The lexer failed to read the '%s' file. Are you sure it exists in the same folder "
+                "as the executable?\n", fileName);
+        return false;
+    }
+    if (fileName == NULL && !LexerOpenBuffer(contents, length, reader->lexer))
+        return false;
+
+    bool readSuccessful = ParseScheduleLexer(reader->lexer, fileData);
+
+    // Let go of the file now, rather than when the next one is read.
+    LexerReset(reader->lexer);
+
+    return readSuccessful;
+}
+
+bool ReadScheduleFile(ScheduleData* fileData)
+{
+    ScheduleReader* reader;
+    if (!ScheduleReaderCreate(&reader))
+    {
+        fileData->processes = NULL;
+        return false;
+    }
+
+    bool readSuccessful = ReadScheduleFileFrom("processes.in", NULL, 0, reader, fileData);
+
+    ScheduleReaderDestroy(&reader);
+
+    return readSuccessful;
+}
+
+bool ReadScheduleBuffer(const char* contents, size_t length, ScheduleData* fileData)
+{
+    ScheduleReader* reader;
+    if (!ScheduleReaderCreate(&reader))
+    {
+        fileData->processes = NULL;
+        return false;
+    }
+
+    bool readSuccessful = ReadScheduleFileFrom(NULL, contents, length, reader, fileData);
+
+    ScheduleReaderDestroy(&reader);
+
+    return readSuccessful;
+}
+
+// Checks whether two processes came from the same line, which is when every value that was read in matches.
+static bool ProcessSameLine(const InputProcess* process1, const InputProcess* process2)
+{
+    if (ProcessArrivalCompareTo(process1, process2) != 0 || process1->burstLength != process2->burstLength)
+        return false;
+    if (process1->command == NULL || process2->command == NULL)
+        return process1->command == process2->command;
+    return strcmp(process1->command, process2->command) == 0;
+}
+
+// Checks whether the text holds the word "end" anywhere, as a word of its own.
+static bool TextHasEndWord(const char* text, size_t length)
+{
+    for (size_t i = 0; i + 3 <= length; i++)
+    {
+        if (text[i] == 'e' && text[i + 1] == 'n' && text[i + 2] == 'd' &&
+            (i == 0 || isspace((unsigned char)text[i - 1])) &&
+            (i + 3 == length || isspace((unsigned char)text[i + 3])))
+            return true;
+    }
+    return false;
+}
+
+// Checks whether the first word after a position in the text is "command", which would continue a process line that
+// came before it.
+static bool TextContinuesProcess(const char* text, size_t position, size_t length)
+{
+    while (position < length)
+    {
+        if (text[position] == '#')
+        {
+            // Skip over comment lines.
+            while (position < length && text[position] != '\n')
+                position++;
         }
-        else if (strcmp(currentToken->strTokenValue, "use") == 0)
+        else if (isspace((unsigned char)text[position]))
         {
-            // The next value in the file should be a string representing the scheduler type we want to use.
-            currentToken = VectorGet(++currentTokenIndex, tokens);
-            if (currentToken->tokenType != String)
-            {
-                fprintf(stderr, "Invalid processes file specified. Found an unexpected digit.\n");
-                readSuccessful = false;
-                break;
-            }
+            position++;
+        }
+        else
+        {
+            return length - position >= 7 && strncmp(text + position, "command", 7) == 0 &&
+                   (length - position == 7 || !isalnum((unsigned char)text[position + 7]));
+        }
+    }
+    return false;
+}
 
-            if (strcmp(currentToken->strTokenValue, "fcfs") == 0)
-            {
-                fileData->schedulerType = FCFS;
-            }
-            else if (strcmp(currentToken->strTokenValue, "sjf") == 0)
-            {
-                fileData->schedulerType = ShortestJob;
-            }
-            else if (strcmp(currentToken->strTokenValue, "rr") == 0)
-            {
-                fileData->schedulerType = RoundRobin;
-            }
-            else
+// Lexes and parses the processes on a range of lines. Fails if the lines hold anything other than whole processes.
+// The lines may finish with "end" only if reachedEnd is given, and it is then set if they did.
+static bool ParseProcessLines(const char* text, size_t length, Vector** processes, bool* reachedEnd)
+{
+    ScheduleData lineData;
+    if (!VectorCreate(sizeof(InputProcess), 8, 0, NULL, ProcessArrivalCompareTo, &lineData.processes))
+        return false;
+
+    // Make room up front for as many processes as the lines could hold, so the vector never grows while parsing.
+    VectorReserve((unsigned int)(length / PROCESS_LINE_MIN_BYTES), lineData.processes);
+
+    Lexer* lexer;
+    if (!LexerCreate(&lexer))
+    {
+        VectorDestroy(&lineData.processes);
+        return false;
+    }
+
+    bool parsed = false;
+    if (LexerOpenBuffer(text, length, lexer))
+    {
+        LexerToken stopToken;
+        parsed = ParseScheduleTokens(lexer, ParseProcessesOnly, &lineData, &stopToken, NULL);
+        if (reachedEnd != NULL)
+            *reachedEnd = stopToken.keyword == KeywordEnd;
+        else if (stopToken.keyword == KeywordEnd)
+            parsed = false;
+    }
+    LexerDestroy(&lexer);
+
+    if (!parsed)
+    {
+        DestroyScheduleFile(&lineData);
+        return false;
+    }
+
+    *processes = lineData.processes;
+    return true;
+}
+
+ScheduleFilePatchResult PatchScheduleFile(ScheduleData* fileData, const char* oldContents, size_t oldLength,
+                                          const char* newContents, size_t newLength)
+{
+    // Find the bytes that are the same at the start and at the end of both versions of the file.
+    size_t shorterLength = oldLength < newLength ? oldLength : newLength;
+    size_t prefixLength = 0;
+    while (prefixLength < shorterLength && oldContents[prefixLength] == newContents[prefixLength])
+        prefixLength++;
+    if (prefixLength == oldLength && prefixLength == newLength)
+        return ScheduleFilePatched;
+
+    size_t suffixLength = 0;
+    while (suffixLength < shorterLength - prefixLength &&
+           oldContents[oldLength - suffixLength - 1] == newContents[newLength - suffixLength - 1])
+        suffixLength++;
+
+    // Widen the change to whole lines, since no token spans lines. The text after the change is the same in both
+    // versions, so the end of the change moves by the same amount in both.
+    size_t changeStart = prefixLength;
+    while (changeStart > 0 && oldContents[changeStart - 1] != '\n')
+        changeStart--;
+
+    size_t oldChangeEnd = oldLength - suffixLength;
+    while (oldChangeEnd > 0 && oldChangeEnd < oldLength && oldContents[oldChangeEnd - 1] != '\n')
+        oldChangeEnd++;
+    size_t newChangeEnd = newLength - (oldLength - oldChangeEnd);
+
+    // Anything after "end" is ignored, so if the unchanged lines before the change might hold it, the change might
+    // not count at all. A process line followed by a "command" line would also gain or lose its command.
+    if (TextHasEndWord(oldContents, changeStart) || TextContinuesProcess(newContents, newChangeEnd, newLength))
+        return ScheduleFileNeedsReparse;
+
+    // Parse the changed lines, as they were and as they are now.
+    Vector* removedProcesses;
+    if (!ParseProcessLines(oldContents + changeStart, oldChangeEnd - changeStart, &removedProcesses, NULL))
+        return ScheduleFileNeedsReparse;
+
+    Vector* addedProcesses;
+    if (!ParseProcessLines(newContents + changeStart, newChangeEnd - changeStart, &addedProcesses, NULL))
+    {
+        ScheduleData removedData = { .processes = removedProcesses };
+        DestroyScheduleFile(&removedData);
+        return ScheduleFileNeedsReparse;
+    }
+
+    // Take out the processes from the old lines. They are found with a binary search, since the processes are sorted
+    // by arrival.
+    ScheduleFilePatchResult result = ScheduleFilePatched;
+    for (unsigned int i = 0; i < VectorCount(removedProcesses); i++)
+    {
+        InputProcess* removed = VectorGet(i, removedProcesses);
+        unsigned int index = VectorLowerBound(removed, fileData->processes);
+        InputProcess* process;
+        while (index < VectorCount(fileData->processes) && (process = VectorGet(index, fileData->processes)) != NULL &&
+               ProcessArrivalCompareTo(process, removed) == 0 && !ProcessSameLine(process, removed))
+            index++;
+
+        if (index == VectorCount(fileData->processes) || !ProcessSameLine(process, removed))
+        {
+            // The processes no longer match the old contents of the file.
+            result = ScheduleFileNeedsReparse;
+            break;
+        }
+
+        free(process->command);
+        VectorRemove((int)index, fileData->processes);
+    }
+
+    // Put the processes from the new lines in their place in arrival order. Their commands now belong to the
+    // schedule's processes.
+    for (unsigned int i = 0; result == ScheduleFilePatched && i < VectorCount(addedProcesses); i++)
+    {
+        InputProcess* added = VectorGet(i, addedProcesses);
+        VectorInsertSorted(added, fileData->processes);
+        added->command = NULL;
+    }
+
+    ScheduleData lineData = { .processes = removedProcesses };
+    DestroyScheduleFile(&lineData);
+    lineData.processes = addedProcesses;
+    DestroyScheduleFile(&lineData);
+
+    return result;
+}
+
+// One chunk of a large processes file, and the processes a thread parsed out of it, sorted by arrival.
+typedef struct tagParseChunk
+{
+    const char* text;
+    size_t length;
+    Vector* processes;
+    bool parsed;
+    bool reachedEnd;
+} ParseChunk;
+
+static void* ParseChunkThread(void* argument)
+{
+    ParseChunk* chunk = argument;
+    chunk->parsed = ParseProcessLines(chunk->text, chunk->length, &chunk->processes, &chunk->reachedEnd);
+    if (chunk->parsed)
+        VectorSort(chunk->processes);
+    return NULL;
+}
+
+// Two tables of processes that are each sorted by arrival, and the table they are merged into.
+typedef struct tagMergeTask
+{
+    Vector* first;
+    Vector* second;
+    Vector* merged;
+} MergeTask;
+
+// Merges two sorted tables of processes. Processes that sort the same keep the order of the tables, so the first
+// table's come first. The processes are moved, so their commands now belong to the merged table.
+static void* MergeProcessTablesThread(void* argument)
+{
+    MergeTask* task = argument;
+    unsigned int firstCount = VectorCount(task->first);
+    unsigned int secondCount = VectorCount(task->second);
+    if (!VectorCreate(sizeof(InputProcess), firstCount + secondCount, 0, NULL, ProcessArrivalCompareTo, &task->merged))
+    {
+        task->merged = NULL;
+        return NULL;
+    }
+
+    // Take turns copying the run of processes from each table that comes before the other table's next process. Runs
+    // are copied in one go, and the chunks of a mostly sorted file come out as a few long runs.
+    unsigned int i = 0;
+    unsigned int j = 0;
+    while (i < firstCount && j < secondCount)
+    {
+        InputProcess* second = VectorGet((int)j, task->second);
+        unsigned int run = i;
+        while (run < firstCount && ProcessArrivalCompareTo(VectorGet((int)run, task->first), second) <= 0)
+            run++;
+        VectorAddRange(VectorGet((int)i, task->first), run - i, task->merged);
+        i = run;
+        if (i == firstCount)
+            break;
+
+        InputProcess* first = VectorGet((int)i, task->first);
+        run = j;
+        while (run < secondCount && ProcessArrivalCompareTo(VectorGet((int)run, task->second), first) < 0)
+            run++;
+        VectorAddRange(second, run - j, task->merged);
+        j = run;
+    }
+    VectorAddRange(VectorGet((int)i, task->first), firstCount - i, task->merged);
+    VectorAddRange(VectorGet((int)j, task->second), secondCount - j, task->merged);
+
+    return NULL;
+}
+
+// Runs a job on a thread of its own, or on the calling thread if no thread can be started.
+static bool StartJob(void* (*job)(void*), void* argument, pthread_t* thread)
+{
+    if (pthread_create(thread, NULL, job, argument) == 0)
+        return true;
+
+    job(argument);
+    return false;
+}
+
+// Parses a large processes file with several threads. The directives at the top are read first, then the rest of the
+// file is split at line breaks into a chunk per thread. Each thread parses and sorts the processes in its chunk, and
+// the sorted chunks are merged in pairs, with the pairs of each round merged at the same time. Returns false, having
+// read nothing, if the file is not worth splitting or the chunks hold anything other than whole process lines; the
+// file then has to be parsed the usual way, which also reports any errors in it.
+static bool ParseScheduleParallel(const char* text, size_t length, ScheduleData* fileData)
+{
+    long processorCount = sysconf(_SC_NPROCESSORS_ONLN);
+    if (processorCount < 2)
+        return false;
+
+    // Read the directives before the first process.
+    Lexer* lexer;
+    if (!LexerCreate(&lexer))
+        return false;
+
+    fileData->processes = NULL;
+    LexerToken firstProcess;
+    int processCount;
+    bool headerParsed = LexerOpenBuffer(text, length, lexer) &&
+                        ParseScheduleTokens(lexer, ParseHeader, fileData, &firstProcess, &processCount);
+    LexerDestroy(&lexer);
+
+    // A process before "processcount" is an error, which the file is parsed in one piece to report.
+    if (!headerParsed || firstProcess.keyword != KeywordProcess || processCount == -1)
+        return false;
+
+    // Split the rest of the file into chunks. A chunk cannot start on a line that continues the process before it.
+    size_t start = (size_t)(firstProcess.strTokenValue - text);
+    size_t chunkCount = (length - start) / PARALLEL_PARSE_MIN_CHUNK_BYTES;
+    if (chunkCount > (size_t)processorCount)
+        chunkCount = (size_t)processorCount;
+    if (chunkCount > PARALLEL_PARSE_MAX_THREADS)
+        chunkCount = PARALLEL_PARSE_MAX_THREADS;
+    if (chunkCount < 2)
+        return false;
+
+    ParseChunk chunks[PARALLEL_PARSE_MAX_THREADS];
+    pthread_t threads[PARALLEL_PARSE_MAX_THREADS];
+    bool started[PARALLEL_PARSE_MAX_THREADS];
+    size_t chunkStart = start;
+    for (size_t i = 0; i < chunkCount; i++)
+    {
+        size_t chunkEnd = length;
+        if (i + 1 < chunkCount)
+        {
+            chunkEnd = start + (length - start) / chunkCount * (i + 1);
+            if (chunkEnd < chunkStart)
+                chunkEnd = chunkStart;
+
+            do
             {
-                fprintf(stderr, "Invalid processes file specified. Unknown scheduler algorithm specified.\n");
-                readSuccessful = false;
-                break;
-            }
+                const char* lineEnd = memchr(text + chunkEnd, '\n', length - chunkEnd);
+                chunkEnd = lineEnd != NULL ? (size_t)(lineEnd - text) + 1 : length;
+            } while (chunkEnd < length && TextContinuesProcess(text, chunkEnd, length));
         }
-        else if (strcmp(currentToken->strTokenValue, "quantum") == 0)
+
+        chunks[i].text = text + chunkStart;
+        chunks[i].length = chunkEnd - chunkStart;
+        chunks[i].processes = NULL;
+        chunkStart = chunkEnd;
+    }
+
+    for (size_t i = 0; i < chunkCount; i++)
+        started[i] = StartJob(ParseChunkThread, &chunks[i], &threads[i]);
+
+    // Anything after "end" is ignored, so so are the chunks after the one that holds it.
+    bool parsed = true;
+    for (size_t i = 0; i < chunkCount; i++)
+    {
+        if (started[i])
+            pthread_join(threads[i], NULL);
+        parsed = parsed && chunks[i].parsed;
+        if (parsed && chunks[i].reachedEnd)
         {
-            // The next value in the file should be a number representing the time quantum value.
-            currentToken = VectorGet(++currentTokenIndex, tokens);
-            if (currentToken->tokenType != Number)
+            for (size_t j = i + 1; j < chunkCount; j++)
             {
-                fprintf(stderr, "Invalid processes file specified. Found an unexpected alphabetic character.\n");
-                readSuccessful = false;
-                break;
+                if (started[j])
+                    pthread_join(threads[j], NULL);
+                ScheduleData chunkData = { .processes = chunks[j].processes };
+                DestroyScheduleFile(&chunkData);
             }
-
-            fileData->timeQuantum = currentToken->numTokenValue;
+            chunkCount = i + 1;
         }
-        else if (strcmp(currentToken->strTokenValue, "process") == 0)
-        {
-            // The next 6 tokens should all be part of a process.
-            InputProcess process;
-            readSuccessful = ParseProcess(tokens, &currentTokenIndex, &process);
+    }
 
-            if (!readSuccessful)
-                break;
+    // Merge neighbouring chunks in rounds, until a single table is left.
+    Vector* tables[PARALLEL_PARSE_MAX_THREADS];
+    for (size_t i = 0; i < chunkCount; i++)
+        tables[i] = chunks[i].processes;
 
-            VectorAdd(&process, fileData->processes);
-        }
-        else if (strcmp(currentToken->strTokenValue, "end") == 0)
+    size_t tableCount = chunkCount;
+    while (parsed && tableCount > 1)
+    {
+        MergeTask tasks[PARALLEL_PARSE_MAX_THREADS / 2];
+        size_t taskCount = tableCount / 2;
+        for (size_t i = 0; i < taskCount; i++)
         {
-            // No work needs to be done. We've reached the end of input.
-            break;
+            tasks[i].first = tables[2 * i];
+            tasks[i].second = tables[2 * i + 1];
+            started[i] = StartJob(MergeProcessTablesThread, &tasks[i], &threads[i]);
         }
-        else
+
+        // Tables that failed to merge are kept as they were, so that they are cleaned up below.
+        Vector* mergedTables[PARALLEL_PARSE_MAX_THREADS];
+        size_t mergedCount = 0;
+        for (size_t i = 0; i < taskCount; i++)
         {
-            // Unknown value specified.
-            fprintf(stderr, "Invalid processes file specified. Found an unexpected string value where a process "
-                    "configuration value was expected.\n");
-            readSuccessful = false;
+            if (started[i])
+                pthread_join(threads[i], NULL);
+
+            if (tasks[i].merged != NULL)
+            {
+                // The processes were moved into the merged table, so only the tables themselves are destroyed.
+                VectorDestroy(&tasks[i].first);
+                VectorDestroy(&tasks[i].second);
+                mergedTables[mergedCount++] = tasks[i].merged;
+            }
+            else
+            {
+                parsed = false;
+                mergedTables[mergedCount++] = tasks[i].first;
+                mergedTables[mergedCount++] = tasks[i].second;
+            }
         }
+        if (tableCount % 2 == 1)
+            mergedTables[mergedCount++] = tables[tableCount - 1];
 
-        currentTokenIndex++;
+        memcpy(tables, mergedTables, mergedCount * sizeof(Vector*));
+        tableCount = mergedCount;
     }
 
-    // The call to LexerDestroy will handle this.
-#if 0
-    // Destroy each dynamically allocated string token.
-    for (int i = 0; i < VectorCount(tokens); i++)
+    if (!parsed)
     {
-        LexerToken* token = VectorGet(i, tokens);
-        if (token->tokenType == String && token->strTokenValue != NULL)
+        LOG_DEBUG(LogInput, "The chunks hold more than process lines, so the file is parsed in one piece");
+        for (size_t i = 0; i < tableCount; i++)
         {
-            free(token->strTokenValue);
-            token->strTokenValue = NULL;
+            ScheduleData chunkData = { .processes = tables[i] };
+            DestroyScheduleFile(&chunkData);
         }
+        return false;
     }
-#endif
 
-    // Destroy the lexer.
-    LexerDestroy(&lexer);
+    fileData->processes = tables[0];
+    LOG_DEBUG(LogInput, "Parsed %zu bytes in %zu chunks", length, chunkCount);
+    return true;
+}
 
-    // Finally, with the processes all read in, sort them so earliest arrivals come in first.
-    VectorSort(fileData->processes);
+void DestroyScheduleFile(ScheduleData* fileData)
+{
+    if (fileData->processes == NULL)
+        return;
 
-    return readSuccessful;
+    // Free the command line of every process that named one.
+    for (unsigned int i = 0; i < VectorCount(fileData->processes); i++)
+    {
+        InputProcess* process = VectorGet(i, fileData->processes);
+        free(process->command);
+        process->command = NULL;
+    }
+
+    VectorDestroy(&fileData->processes);
 }
\ No newline at end of file
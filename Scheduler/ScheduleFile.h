@@ -4,8 +4,11 @@
 
 #pragma once
 
+#include <CLib/SmallVector.h>
+#include <CLib/TypedVector.h>
 #include <CLib/Vector.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 /**
  * Represents the different scheduler types.
@@ -63,8 +66,23 @@ typedef struct tagInputProcess
 	*/
 	unsigned int turnaroundTime;
 
+    /**
+     * The command line to run for this process when the processes are executed for real, stored as a dynamically
+     * allocated C String. NULL if the process did not name a command.
+     */
+    char* command;
+
 } InputProcess;
 
+// A typed vector of processes, InputProcessVector, for the schedulers' queues.
+CLIB_DEFINE_VECTOR(InputProcess)
+
+// The number of processes a scheduler keeps on the stack before moving its copy of them to the heap.
+#define SCHEDULER_INLINE_PROCESSES 16
+
+// A small vector of processes, InputProcessSmallVector, for a scheduler's working copy of the processes.
+CLIB_DEFINE_SMALL_VECTOR(InputProcess, SCHEDULER_INLINE_PROCESSES)
+
 /**
  * Contains all the data read in from the "processes.in" file.
  */
@@ -92,6 +110,53 @@ typedef struct tagScheduleData
     Vector* processes;
 } ScheduleData;
 
+/**
+ * Orders processes by arrival time, and processes that arrive together by name. This is the order the processes of a
+ * ScheduleData object are kept in.
+ *
+ * @param obj1 The first InputProcess.
+ * @param obj2 The second InputProcess.
+ * @return Less than, equal to or greater than 0 if the first process sorts before, with or after the second.
+ */
+int ProcessArrivalCompareTo(const void* obj1, const void* obj2);
+
+/**
+ * Holds what it takes to read processes files, so that it can be kept and reused from one file to the next. A reader
+ * that is reused does not allocate anything for itself once it has read its largest file; only the ScheduleData
+ * objects it fills in are allocated.
+ */
+typedef struct tagScheduleReader ScheduleReader;
+
+/**
+ * Creates a reader for processes files.
+ *
+ * @param reader A pointer to the reader object to initialize.
+ * @return True if the operation succeeds, otherwise false.
+ */
+bool ScheduleReaderCreate(ScheduleReader** reader);
+
+/**
+ * Destroys a reader for processes files.
+ *
+ * @param reader A pointer to the reader object to destroy.
+ */
+void ScheduleReaderDestroy(ScheduleReader** reader);
+
+/**
+ * Reads a processes file with a reader that is kept between files, and updates the ScheduleData object just like
+ * ReadScheduleFile. A call to DestroyScheduleFile is necessary after use, even if reading fails.
+ *
+ * @param fileName The name of the processes file to read. If NULL, contents is read instead.
+ * @param contents The contents of a processes file that were already read into memory, if fileName is NULL. They do
+ * not need to be null terminated.
+ * @param length The length of the contents, in bytes.
+ * @param reader The reader to read the file with.
+ * @param file The ScheduleData object to update with the data obtained from the file.
+ * @return True if the operation succeeds, otherwise false.
+ */
+bool ReadScheduleFileFrom(const char* fileName, const char* contents, size_t length, ScheduleReader* reader,
+                          ScheduleData* file);
+
 /**
  * Reads the "processes.in" file, parses it, and updates the ScheduleData object with the data parsed from the
  * processes file. A call to DestroyScheduleFile is necessary after use to ensure dynamically allocated process
@@ -100,4 +165,57 @@ typedef struct tagScheduleData
  * @param file The ScheduleData object to update with the data obtained from the "processes.in" file.
  * @return True if the operation succeeds, otherwise false.
  */
-bool ReadScheduleFile(ScheduleData* file);
\ No newline at end of file
+bool ReadScheduleFile(ScheduleData* file);
+
+/**
+ * Parses the contents of a processes file that were already read into memory, and updates the ScheduleData object
+ * just like ReadScheduleFile. A call to DestroyScheduleFile is necessary after use, even if parsing fails.
+ *
+ * @param contents The contents of the processes file. They do not need to be null terminated.
+ * @param length The length of the contents, in bytes.
+ * @param file The ScheduleData object to update with the data obtained from the contents.
+ * @return True if the operation succeeds, otherwise false.
+ */
+bool ReadScheduleBuffer(const char* contents, size_t length, ScheduleData* file);
+
+/**
+ * The outcomes of patching a ScheduleData object after its processes file changed.
+ */
+typedef enum tagScheduleFilePatchResult
+{
+    /**
+     * The ScheduleData object now matches the new contents of the file.
+     */
+    ScheduleFilePatched = 0,
+
+    /**
+     * The change could not be patched in, and the whole file has to be read again. The ScheduleData object can still
+     * be destroyed, but its processes no longer match either version of the file.
+     */
+    ScheduleFileNeedsReparse = 1
+} ScheduleFilePatchResult;
+
+/**
+ * @brief Updates a ScheduleData object for a change to its processes file, by parsing only the lines that changed.
+ *
+ * The lines that differ between the old and new contents are found by comparing the two from both ends. The old
+ * lines are lexed again to find the processes to take out, and the new lines are lexed to find the processes to put
+ * in. Both are found with a binary search on arrival order, so the processes stay sorted without sorting them again.
+ * Only changes to "process" lines can be patched; any other change needs the whole file to be read again.
+ *
+ * @param file The ScheduleData object that was read from the old contents.
+ * @param oldContents The contents of the file that the ScheduleData object was read from.
+ * @param oldLength The length of the old contents, in bytes.
+ * @param newContents The new contents of the file.
+ * @param newLength The length of the new contents, in bytes.
+ * @return Whether the change was patched in, or the file has to be read again.
+ */
+ScheduleFilePatchResult PatchScheduleFile(ScheduleData* file, const char* oldContents, size_t oldLength,
+                                          const char* newContents, size_t newLength);
+
+/**
+ * Releases the dynamically allocated memory held by a ScheduleData object that was filled in by ReadScheduleFile.
+ *
+ * @param file The ScheduleData object to destroy.
+ */
+void DestroyScheduleFile(ScheduleData* file);
\ No newline at end of file
@@ -0,0 +1,139 @@
+/**
+ * @file Timeline.c
+ */
+
+#include "Timeline.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+/**
+ * The counters kept for one bucket of time.
+ */
+typedef struct tagTimelineBucket
+{
+    unsigned int busyTicks;
+    unsigned int idleTicks;
+    unsigned int contextSwitches;
+    unsigned int arrivals;
+    unsigned int completions;
+    unsigned int peakReadyQueueLength;
+} TimelineBucket;
+
+/**
+ * Internal representation of a Timeline.
+ */
+typedef struct tagTimeline
+{
+    /**
+     * The buckets, in time order.
+     */
+    TimelineBucket* buckets;
+    /**
+     * The number of buckets.
+     */
+    unsigned int bucketCount;
+    /**
+     * The number of ticks covered by each bucket.
+     */
+    unsigned int bucketWidth;
+} Timeline;
+
+/**
+ * Gets the bucket a time falls into. Times outside of the run are put in the first or last bucket.
+ */
+static TimelineBucket* TimelineGetBucket(int time, Timeline* timeline)
+{
+    if (time < 0)
+        return &timeline->buckets[0];
+
+    unsigned int index = (unsigned int)time / timeline->bucketWidth;
+    if (index >= timeline->bucketCount)
+        index = timeline->bucketCount - 1;
+
+    return &timeline->buckets[index];
+}
+
+bool TimelineCreate(unsigned int runLength, unsigned int bucketCount, Timeline** timeline)
+{
+    if (bucketCount == 0)
+        return false;
+
+    *timeline = calloc(1, sizeof(Timeline));
+    if (*timeline == NULL)
+        return false;
+
+    // The run covers runLength + 1 ticks. Round the width up so that every tick has a bucket, and drop any buckets
+    // that would start after the end of the run.
+    unsigned long long ticks = (unsigned long long)runLength + 1;
+    (*timeline)->bucketWidth = (unsigned int)((ticks + bucketCount - 1) / bucketCount);
+    (*timeline)->bucketCount = (unsigned int)((ticks + (*timeline)->bucketWidth - 1) / (*timeline)->bucketWidth);
+
+    (*timeline)->buckets = calloc((*timeline)->bucketCount, sizeof(TimelineBucket));
+    if ((*timeline)->buckets == NULL)
+    {
+        free(*timeline);
+        *timeline = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+void TimelineDestroy(Timeline** timeline)
+{
+    free((*timeline)->buckets);
+    free(*timeline);
+    *timeline = NULL;
+}
+
+void TimelineRecordTick(int time, bool busy, unsigned int readyQueueLength, Timeline* timeline)
+{
+    TimelineBucket* bucket = TimelineGetBucket(time, timeline);
+
+    if (busy)
+        bucket->busyTicks++;
+    else
+        bucket->idleTicks++;
+
+    if (readyQueueLength > bucket->peakReadyQueueLength)
+        bucket->peakReadyQueueLength = readyQueueLength;
+}
+
+void TimelineRecordContextSwitch(int time, Timeline* timeline)
+{
+    TimelineGetBucket(time, timeline)->contextSwitches++;
+}
+
+void TimelineRecordArrival(int time, Timeline* timeline)
+{
+    TimelineGetBucket(time, timeline)->arrivals++;
+}
+
+void TimelineRecordCompletion(int time, Timeline* timeline)
+{
+    TimelineGetBucket(time, timeline)->completions++;
+}
+
+bool TimelineWrite(const char* fileName, Timeline* timeline)
+{
+    FILE* file = fopen(fileName, "w");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Failed to open the timeline file '%s'.\n", fileName);
+        return false;
+    }
+
+    fprintf(file, "# bucket width %u: start busy idle switches arrivals completions peak_ready\n",
+            timeline->bucketWidth);
+    for (unsigned int i = 0; i < timeline->bucketCount; i++)
+    {
+        TimelineBucket* bucket = &timeline->buckets[i];
+        fprintf(file, "%llu %u %u %u %u %u %u\n", (unsigned long long)i * timeline->bucketWidth, bucket->busyTicks,
+                bucket->idleTicks, bucket->contextSwitches, bucket->arrivals, bucket->completions,
+                bucket->peakReadyQueueLength);
+    }
+
+    bool succeeded = !ferror(file);
+    fclose(file);
+    return succeeded;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file Timeline.h
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+/**
+ * @brief Represents a utilization timeline of a scheduler run.
+ *
+ * The run is cut into a fixed number of equally sized time buckets, and each bucket keeps a handful of counters: busy
+ * ticks, idle ticks, context switches, arrivals, completions and the peak ready queue length. Recording an event is
+ * O(1), and the memory used only depends on the number of buckets, no matter how long the run is.
+ */
+typedef struct tagTimeline Timeline;
+
+/**
+ * Creates a new timeline covering the times 0 through runLength.
+ * @param runLength The last time of the run.
+ * @param bucketCount The number of buckets to split the run into.
+ * @param timeline A pointer to the timeline object to initialize.
+ * @return True if the operation succeeded, otherwise false.
+ */
+bool TimelineCreate(unsigned int runLength, unsigned int bucketCount, Timeline** timeline);
+
+/**
+ * Destroys a timeline.
+ * @param timeline A pointer to the timeline object to destroy.
+ */
+void TimelineDestroy(Timeline** timeline);
+
+/**
+ * Records one simulated tick.
+ * @param time The time of the tick.
+ * @param busy True if a process ran during the tick, false if the CPU was idle.
+ * @param readyQueueLength The number of processes in the ready queue during the tick, counting the running one.
+ * @param timeline The timeline to record the tick in.
+ */
+void TimelineRecordTick(int time, bool busy, unsigned int readyQueueLength, Timeline* timeline);
+
+/**
+ * Records that a process was selected to run.
+ * @param time The time of the event.
+ * @param timeline The timeline to record the event in.
+ */
+void TimelineRecordContextSwitch(int time, Timeline* timeline);
+
+/**
+ * Records that a process arrived.
+ * @param time The time of the event.
+ * @param timeline The timeline to record the event in.
+ */
+void TimelineRecordArrival(int time, Timeline* timeline);
+
+/**
+ * Records that a process finished.
+ * @param time The time of the event.
+ * @param timeline The timeline to record the event in.
+ */
+void TimelineRecordCompletion(int time, Timeline* timeline);
+
+/**
+ * @brief Writes the timeline to a file.
+ *
+ * The file starts with a comment line giving the bucket width, followed by one line per bucket holding the bucket's
+ * start time, busy ticks, idle ticks, context switches, arrivals, completions and peak ready queue length, separated
+ * by spaces.
+ *
+ * @param fileName The name of the file to write.
+ * @param timeline The timeline to write.
+ * @return True if the operation succeeded, otherwise false.
+ */
+bool TimelineWrite(const char* fileName, Timeline* timeline);
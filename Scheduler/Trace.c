@@ -0,0 +1,380 @@
+/**
+ * @file Trace.c
+ */
+
+#define _GNU_SOURCE
+
+#include "Trace.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+
+/**
+ * The number of events the ring between the scheduler and the writer thread can hold. Must be a power of two.
+ */
+#define TRACE_RING_CAPACITY 65536
+
+/**
+ * The size of the stdio buffer used for the trace file.
+ */
+#define TRACE_FILE_BUFFER_SIZE (1 << 20)
+
+/**
+ * The different kinds of events a trace records.
+ */
+typedef enum tagTraceEventType
+{
+    ArrivedEvent,
+    SelectedEvent,
+    FinishedEvent,
+    IdleEvent,
+    /**
+     * Free-form text. The event owns the text and frees it once it is written.
+     */
+    TextEvent
+} TraceEventType;
+
+/**
+ * One recorded event, stored in the ring until the writer gets to it.
+ */
+typedef struct tagTraceEvent
+{
+    TraceEventType eventType;
+    int time;
+    int burst;
+    /**
+     * The process name, or the text of a TextEvent.
+     */
+    const char* text;
+} TraceEvent;
+
+/**
+ * Internal representation of a Trace.
+ */
+typedef struct tagTrace
+{
+    /**
+     * The file the trace is written to.
+     */
+    FILE* file;
+    /**
+     * The buffer given to stdio for the file.
+     */
+    char* fileBuffer;
+    /**
+     * True if a writer thread formats and writes the events.
+     */
+    bool asynchronous;
+    /**
+     * The events waiting for the writer thread.
+     */
+    TraceEvent* ring;
+    /**
+     * The number of events ever pushed into the ring. Only written by the recording thread.
+     */
+    size_t head;
+    /**
+     * The number of events ever written out of the ring. Only written by the writer thread.
+     */
+    size_t tail;
+    /**
+     * Set once nothing more will be recorded, which tells the writer thread to finish up.
+     */
+    bool closing;
+    /**
+     * The writer thread.
+     */
+    pthread_t writerThread;
+    /**
+     * The timeline that counts the recorded events, or NULL if there is none.
+     */
+    Timeline* timeline;
+    /**
+     * The seek index file, or NULL if the trace is not indexed.
+     */
+    FILE* indexFile;
+    /**
+     * The number of time units between index entries.
+     */
+    unsigned int indexStride;
+    /**
+     * The earliest time that gets the next index entry.
+     */
+    uint64_t nextIndexedTime;
+    /**
+     * The number of bytes written to the trace file so far.
+     */
+    uint64_t bytesWritten;
+} Trace;
+
+/**
+ * Formats one event into the trace file.
+ */
+static void TraceWriteEvent(const TraceEvent* event, Trace* trace)
+{
+    // Index the first event at or after each multiple of the stride. Events come in time order, so the lines before
+    // the indexed one all have earlier times.
+    if (trace->indexFile != NULL && event->eventType != TextEvent && event->time >= 0 &&
+        (uint64_t)event->time >= trace->nextIndexedTime)
+    {
+        uint64_t entry[2] = { (uint64_t)event->time, trace->bytesWritten };
+        fwrite(entry, sizeof(entry), 1, trace->indexFile);
+        trace->nextIndexedTime = ((uint64_t)event->time / trace->indexStride + 1) * trace->indexStride;
+    }
+
+    int written = 0;
+    switch (event->eventType)
+    {
+        case ArrivedEvent:
+            written = fprintf(trace->file, "Time %d: %s arrived\n", event->time, event->text);
+            break;
+        case SelectedEvent:
+            written = fprintf(trace->file, "Time %d: %s selected (burst %d)\n", event->time, event->text,
+                              event->burst);
+            break;
+        case FinishedEvent:
+            written = fprintf(trace->file, "Time %d: %s finished\n", event->time, event->text);
+            break;
+        case IdleEvent:
+            written = fprintf(trace->file, "Time %d: IDLE\n", event->time);
+            break;
+        case TextEvent:
+            fputs(event->text, trace->file);
+            written = (int)strlen(event->text);
+            free((char*)event->text);
+            break;
+    }
+
+    if (written > 0)
+        trace->bytesWritten += (uint64_t)written;
+}
+
+/**
+ * The writer thread. Drains the ring in batches until the trace is closed and the ring is empty.
+ */
+static void* TraceWriterMain(void* argument)
+{
+    Trace* trace = argument;
+    size_t tail = trace->tail;
+
+    for (;;)
+    {
+        size_t head = __atomic_load_n(&trace->head, __ATOMIC_ACQUIRE);
+        if (head == tail)
+        {
+            // The ring is empty. The closing flag is set after the last event is pushed, so once it is seen, one
+            // more look at the head is enough to know whether anything is left.
+            if (__atomic_load_n(&trace->closing, __ATOMIC_ACQUIRE))
+            {
+                if (__atomic_load_n(&trace->head, __ATOMIC_ACQUIRE) == tail)
+                    break;
+                continue;
+            }
+
+            // Give the scheduler a moment to record more events.
+            struct timespec pause = { 0, 50000 };
+            nanosleep(&pause, NULL);
+            continue;
+        }
+
+        // Write everything that is available, then hand the slots back in one go.
+        for (; tail != head; tail++)
+            TraceWriteEvent(&trace->ring[tail & (TRACE_RING_CAPACITY - 1)], trace);
+        __atomic_store_n(&trace->tail, tail, __ATOMIC_RELEASE);
+    }
+
+    return NULL;
+}
+
+/**
+ * Records an event, either by writing it right away or by handing it to the writer thread.
+ */
+static void TracePush(const TraceEvent* event, Trace* trace)
+{
+    if (!trace->asynchronous)
+    {
+        TraceWriteEvent(event, trace);
+        return;
+    }
+
+    // Wait for the writer thread if the ring is full.
+    size_t head = trace->head;
+    while (head - __atomic_load_n(&trace->tail, __ATOMIC_ACQUIRE) == TRACE_RING_CAPACITY)
+        sched_yield();
+
+    trace->ring[head & (TRACE_RING_CAPACITY - 1)] = *event;
+    __atomic_store_n(&trace->head, head + 1, __ATOMIC_RELEASE);
+}
+
+bool TraceOpen(const char* fileName, bool asynchronous, Trace** trace)
+{
+    *trace = calloc(1, sizeof(Trace));
+    if (*trace == NULL)
+        return false;
+
+    Trace* newTrace = *trace;
+    newTrace->file = fopen(fileName, "w");
+    if (newTrace->file == NULL)
+    {
+        fprintf(stderr, "Error opening output file\n");
+        free(newTrace);
+        *trace = NULL;
+        return false;
+    }
+
+    // A large stdio buffer keeps the number of write calls down on long traces.
+    newTrace->fileBuffer = malloc(TRACE_FILE_BUFFER_SIZE);
+    if (newTrace->fileBuffer != NULL)
+        setvbuf(newTrace->file, newTrace->fileBuffer, _IOFBF, TRACE_FILE_BUFFER_SIZE);
+
+    if (asynchronous)
+    {
+        newTrace->ring = malloc(sizeof(TraceEvent) * TRACE_RING_CAPACITY);
+        if (newTrace->ring != NULL && pthread_create(&newTrace->writerThread, NULL, TraceWriterMain, newTrace) == 0)
+        {
+            newTrace->asynchronous = true;
+        }
+        else
+        {
+            // Fall back to writing on the calling thread. The output is the same either way.
+            free(newTrace->ring);
+            newTrace->ring = NULL;
+        }
+    }
+
+    return true;
+}
+
+bool TraceEnableIndex(const char* fileName, unsigned int stride, Trace* trace)
+{
+    if (stride == 0)
+        return false;
+
+    trace->indexFile = fopen(fileName, "wb");
+    if (trace->indexFile == NULL)
+    {
+        fprintf(stderr, "Failed to open the index file '%s'.\n", fileName);
+        return false;
+    }
+
+    uint32_t header[2];
+    memcpy(&header[0], "SIDX", 4);
+    header[1] = stride;
+    fwrite(header, sizeof(header), 1, trace->indexFile);
+
+    trace->indexStride = stride;
+    trace->nextIndexedTime = 0;
+    return true;
+}
+
+void TraceSetTimeline(Timeline* timeline, Trace* trace)
+{
+    trace->timeline = timeline;
+}
+
+void TraceFlush(Trace* trace)
+{
+    if (!trace->asynchronous)
+        return;
+
+    // The writer thread hands slots back once they are written, so the ring is drained when the tail catches up.
+    while (__atomic_load_n(&trace->tail, __ATOMIC_ACQUIRE) != trace->head)
+        sched_yield();
+}
+
+void TraceClose(Trace** trace)
+{
+    Trace* oldTrace = *trace;
+
+    // Let the writer thread drain the ring, and wait for it to finish.
+    if (oldTrace->asynchronous)
+    {
+        __atomic_store_n(&oldTrace->closing, true, __ATOMIC_RELEASE);
+        pthread_join(oldTrace->writerThread, NULL);
+        free(oldTrace->ring);
+    }
+
+    fclose(oldTrace->file);
+    free(oldTrace->fileBuffer);
+    if (oldTrace->indexFile != NULL)
+        fclose(oldTrace->indexFile);
+    free(oldTrace);
+    *trace = NULL;
+}
+
+void TraceArrived(int time, const char* processName, Trace* trace)
+{
+    if (trace->timeline != NULL)
+        TimelineRecordArrival(time, trace->timeline);
+
+    TraceEvent event = { ArrivedEvent, time, 0, processName };
+    TracePush(&event, trace);
+}
+
+void TraceSelected(int time, const char* processName, int burst, Trace* trace)
+{
+    if (trace->timeline != NULL)
+        TimelineRecordContextSwitch(time, trace->timeline);
+
+    TraceEvent event = { SelectedEvent, time, burst, processName };
+    TracePush(&event, trace);
+}
+
+void TraceFinished(int time, const char* processName, Trace* trace)
+{
+    if (trace->timeline != NULL)
+        TimelineRecordCompletion(time, trace->timeline);
+
+    TraceEvent event = { FinishedEvent, time, 0, processName };
+    TracePush(&event, trace);
+}
+
+void TraceIdle(int time, Trace* trace)
+{
+    TraceEvent event = { IdleEvent, time, 0, NULL };
+    TracePush(&event, trace);
+}
+
+void TraceTick(int time, bool busy, unsigned int readyQueueLength, Trace* trace)
+{
+    if (trace->timeline != NULL)
+        TimelineRecordTick(time, busy, readyQueueLength, trace->timeline);
+}
+
+void TracePrintf(Trace* trace, const char* format, ...)
+{
+    va_list arguments;
+
+    if (!trace->asynchronous)
+    {
+        va_start(arguments, format);
+        int written = vfprintf(trace->file, format, arguments);
+        va_end(arguments);
+        if (written > 0)
+            trace->bytesWritten += (uint64_t)written;
+        return;
+    }
+
+    // Format the text now, since the arguments may not outlive this call, and let the writer thread free it.
+    va_start(arguments, format);
+    int length = vsnprintf(NULL, 0, format, arguments);
+    va_end(arguments);
+    if (length < 0)
+        return;
+
+    char* text = malloc((size_t)length + 1);
+    if (text == NULL)
+        return;
+    va_start(arguments, format);
+    vsnprintf(text, (size_t)length + 1, format, arguments);
+    va_end(arguments);
+
+    TraceEvent event = { TextEvent, 0, 0, text };
+    TracePush(&event, trace);
+}
@@ -0,0 +1,114 @@
+/**
+ * @file Trace.h
+ */
+
+#pragma once
+
+#include "Timeline.h"
+#include <stdbool.h>
+
+/**
+ * Represents the "processes.out" trace that a scheduler writes its events and results to.
+ */
+typedef struct tagTrace Trace;
+
+/**
+ * @brief Opens a trace file for writing.
+ *
+ * A synchronous trace formats and writes every event on the calling thread. An asynchronous trace hands events to a
+ * writer thread through a lock-free single producer, single consumer ring, so the scheduler keeps simulating while the
+ * writer formats and writes its output on another core. Both produce identical files. Events must only be recorded
+ * from one thread.
+ *
+ * @param fileName The name of the file to write.
+ * @param asynchronous True to format and write the trace on a separate writer thread.
+ * @param trace A pointer to the trace object to initialize.
+ * @return True if the operation succeeded, otherwise false.
+ */
+bool TraceOpen(const char* fileName, bool asynchronous, Trace** trace);
+
+/**
+ * @brief Makes the trace also write a sparse seek index.
+ *
+ * The index maps the first event at or after every multiple of the stride to the byte offset of its line in the trace
+ * file, which lets TraceQuery find the events around a given time without reading the whole trace. The index file
+ * starts with the four bytes "SIDX" and the stride as a 32 bit unsigned integer, followed by entries of a 64 bit
+ * unsigned time and a 64 bit unsigned byte offset, all in host byte order. Must be called before anything is recorded.
+ *
+ * @param fileName The name of the index file to write.
+ * @param stride The number of time units between index entries.
+ * @param trace The trace to index.
+ * @return True if the operation succeeded, otherwise false.
+ */
+bool TraceEnableIndex(const char* fileName, unsigned int stride, Trace* trace);
+
+/**
+ * Attaches a timeline to the trace. From then on, the arrivals, selections, completions and ticks recorded in the
+ * trace are also counted in the timeline. The trace does not take ownership of the timeline.
+ * @param timeline The timeline to attach, or NULL to detach the current one.
+ * @param trace The trace to attach the timeline to.
+ */
+void TraceSetTimeline(Timeline* timeline, Trace* trace);
+
+/**
+ * Waits until everything recorded so far has been written out. After this returns, the names passed in earlier
+ * events no longer need to stay valid.
+ * @param trace The trace to flush.
+ */
+void TraceFlush(Trace* trace);
+
+/**
+ * Writes out everything that was recorded, then closes the trace file and destroys the trace.
+ * @param trace A pointer to the trace object to destroy.
+ */
+void TraceClose(Trace** trace);
+
+/**
+ * Records that a process arrived. The name is not copied, and has to stay valid until the trace is flushed.
+ * @param time The time of the event.
+ * @param processName The name of the process.
+ * @param trace The trace to record the event in.
+ */
+void TraceArrived(int time, const char* processName, Trace* trace);
+
+/**
+ * Records that a process was selected to run. The name is not copied, and has to stay valid until the trace is
+ * flushed.
+ * @param time The time of the event.
+ * @param processName The name of the process.
+ * @param burst The remaining burst length of the process.
+ * @param trace The trace to record the event in.
+ */
+void TraceSelected(int time, const char* processName, int burst, Trace* trace);
+
+/**
+ * Records that a process finished. The name is not copied, and has to stay valid until the trace is flushed.
+ * @param time The time of the event.
+ * @param processName The name of the process.
+ * @param trace The trace to record the event in.
+ */
+void TraceFinished(int time, const char* processName, Trace* trace);
+
+/**
+ * Records that no process was ready to run.
+ * @param time The time of the event.
+ * @param trace The trace to record the event in.
+ */
+void TraceIdle(int time, Trace* trace);
+
+/**
+ * Records one simulated tick. Nothing is written to the trace file for it, but an attached timeline counts it.
+ * @param time The time of the tick.
+ * @param busy True if a process ran during the tick, false if the CPU was idle.
+ * @param readyQueueLength The number of processes in the ready queue during the tick, counting the running one.
+ * @param trace The trace to record the tick in.
+ */
+void TraceTick(int time, bool busy, unsigned int readyQueueLength, Trace* trace);
+
+/**
+ * Writes free-form text, such as the header and the results, to the trace. The text is formatted right away, so the
+ * arguments do not need to stay valid.
+ * @param trace The trace to write to.
+ * @param format A printf style format string.
+ */
+void TracePrintf(Trace* trace, const char* format, ...);
@@ -0,0 +1,157 @@
+/**
+ * @file TraceQuery.c
+ *
+ * Prints the events of a "processes.out" trace that happened within a range of time, using the sparse seek index the
+ * Scheduler writes with --index. The index is binary searched for the last entry at or before the start of the range,
+ * so only the part of the trace around the range is read.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+/**
+ * The size of the index file header: the "SIDX" magic and the stride.
+ */
+#define INDEX_HEADER_SIZE 8
+
+/**
+ * The size of one index entry: a time and a byte offset.
+ */
+#define INDEX_ENTRY_SIZE 16
+
+/**
+ * Reads the index entry at the given position.
+ */
+bool ReadIndexEntry(FILE* index, long entryNumber, uint64_t* time, uint64_t* offset)
+{
+    uint64_t entry[2];
+    if (fseek(index, INDEX_HEADER_SIZE + entryNumber * INDEX_ENTRY_SIZE, SEEK_SET) != 0 ||
+        fread(entry, sizeof(entry), 1, index) != 1)
+        return false;
+
+    *time = entry[0];
+    *offset = entry[1];
+    return true;
+}
+
+/**
+ * Finds the byte offset in the trace to start reading from to see every event at or after the given time.
+ */
+bool FindStartOffset(const char* indexName, uint64_t startTime, uint64_t* offset)
+{
+    FILE* index = fopen(indexName, "rb");
+    if (index == NULL)
+    {
+        fprintf(stderr, "Failed to open the index file '%s'. Was the trace written with --index?\n", indexName);
+        return false;
+    }
+
+    // Check the header.
+    char magic[4];
+    uint32_t stride;
+    if (fread(magic, sizeof(magic), 1, index) != 1 || memcmp(magic, "SIDX", 4) != 0 ||
+        fread(&stride, sizeof(stride), 1, index) != 1)
+    {
+        fprintf(stderr, "'%s' is not a trace index file.\n", indexName);
+        fclose(index);
+        return false;
+    }
+
+    fseek(index, 0, SEEK_END);
+    long entryCount = (ftell(index) - INDEX_HEADER_SIZE) / INDEX_ENTRY_SIZE;
+
+    // Binary search for the last entry whose time is at or before the start time. If there is none, the events of
+    // interest start at the beginning of the trace.
+    *offset = 0;
+    long low = 0;
+    long high = entryCount - 1;
+    while (low <= high)
+    {
+        long middle = low + (high - low) / 2;
+        uint64_t entryTime, entryOffset;
+        if (!ReadIndexEntry(index, middle, &entryTime, &entryOffset))
+        {
+            fprintf(stderr, "Failed to read the index file '%s'.\n", indexName);
+            fclose(index);
+            return false;
+        }
+
+        if (entryTime <= startTime)
+        {
+            *offset = entryOffset;
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+
+    fclose(index);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        printf("Usage: TraceQuery <trace file> <start time> [end time]\n\n");
+        printf("Prints the events of the trace from the start time through the end time. The index written next to\n");
+        printf("the trace by 'Scheduler --index <stride>' is used to seek straight to the start time.\n");
+        return argc == 1 ? 0 : -1;
+    }
+
+    const char* traceName = argv[1];
+    uint64_t startTime = strtoull(argv[2], NULL, 10);
+    uint64_t endTime = argc > 3 ? strtoull(argv[3], NULL, 10) : startTime;
+
+    // The index sits next to the trace.
+    size_t traceNameLength = strlen(traceName);
+    char* indexName = malloc(traceNameLength + sizeof(".idx"));
+    memcpy(indexName, traceName, traceNameLength);
+    memcpy(indexName + traceNameLength, ".idx", sizeof(".idx"));
+
+    uint64_t offset;
+    bool found = FindStartOffset(indexName, startTime, &offset);
+    free(indexName);
+    if (!found)
+        return -1;
+
+    FILE* trace = fopen(traceName, "r");
+    if (trace == NULL)
+    {
+        fprintf(stderr, "Failed to open the trace file '%s'.\n", traceName);
+        return -1;
+    }
+    if (fseek(trace, (long)offset, SEEK_SET) != 0)
+    {
+        fprintf(stderr, "Failed to seek in the trace file '%s'.\n", traceName);
+        fclose(trace);
+        return -1;
+    }
+
+    // Print the event lines in the range. Events are in time order, so reading stops at the first one past the end
+    // of the range, or at the results that follow the last event.
+    char line[512];
+    while (fgets(line, sizeof(line), trace) != NULL)
+    {
+        unsigned long long time;
+        if (sscanf(line, "Time %llu:", &time) != 1)
+        {
+            if (strncmp(line, "Finished at time", 16) == 0)
+                break;
+            continue;
+        }
+
+        if (time > endTime)
+            break;
+        if (time >= startTime)
+            fputs(line, stdout);
+    }
+
+    fclose(trace);
+    return 0;
+}
@@ -0,0 +1,205 @@
+/**
+ * @file Watch.c
+ */
+
+#define _GNU_SOURCE
+
+#include "Watch.h"
+#include "Log.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+
+/**
+ * How long to wait for more events after the file changes, so that a save that takes several writes is read once.
+ */
+#define WATCH_SETTLE_MILLISECONDS 20
+
+/**
+ * Reads a whole file into memory.
+ */
+static bool ReadWholeFile(const char* fileName, char** contents, size_t* length)
+{
+    FILE* file = fopen(fileName, "rb");
+    if (file == NULL)
+        return false;
+
+    struct stat fileStats;
+    if (fstat(fileno(file), &fileStats) == -1)
+    {
+        fclose(file);
+        return false;
+    }
+
+    *length = (size_t)fileStats.st_size;
+    *contents = malloc(*length + 1);
+    if (*contents == NULL)
+    {
+        fclose(file);
+        return false;
+    }
+
+    bool succeeded = fread(*contents, 1, *length, file) == *length;
+    fclose(file);
+    if (!succeeded)
+    {
+        free(*contents);
+        *contents = NULL;
+    }
+
+    return succeeded;
+}
+
+/**
+ * Gets the current time, in milliseconds.
+ */
+static double WatchGetMilliseconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
+
+/**
+ * Waits until the file is changed, and returns once no more changes have come in for a moment.
+ */
+static bool WaitForChange(int watchDescriptor, const char* baseName)
+{
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    bool changed = false;
+    while (true)
+    {
+        // Block until the first change, then only wait a moment for any that follow it.
+        struct pollfd pollDescriptor = { .fd = watchDescriptor, .events = POLLIN };
+        int ready = poll(&pollDescriptor, 1, changed ? WATCH_SETTLE_MILLISECONDS : -1);
+        if (ready == 0)
+            return true;
+        if (ready < 0)
+            return false;
+
+        ssize_t bytesRead = read(watchDescriptor, buffer, sizeof(buffer));
+        if (bytesRead <= 0)
+            return false;
+
+        for (char* position = buffer; position < buffer + bytesRead;)
+        {
+            struct inotify_event* event = (struct inotify_event*)position;
+            if (event->len > 0 && strcmp(event->name, baseName) == 0)
+                changed = true;
+            position += sizeof(struct inotify_event) + event->len;
+        }
+    }
+}
+
+bool WatchScheduleFile(const char* fileName, WatchCallback* onChange, void* context)
+{
+    // Watch the directory rather than the file, since saving by renaming a new file over it replaces the file.
+    const char* baseName = strrchr(fileName, '/');
+    char* directoryName = baseName != NULL ? strndup(fileName, (size_t)(baseName - fileName) + 1) : strdup(".");
+    baseName = baseName != NULL ? baseName + 1 : fileName;
+
+    int watchDescriptor = inotify_init1(IN_CLOEXEC);
+    if (watchDescriptor == -1 ||
+        inotify_add_watch(watchDescriptor, directoryName, IN_CLOSE_WRITE | IN_MOVED_TO) == -1)
+    {
+        fprintf(stderr, "Failed to watch '%s' for changes.\n", fileName);
+        if (watchDescriptor != -1)
+            close(watchDescriptor);
+        free(directoryName);
+        return false;
+    }
+    free(directoryName);
+
+    // Read the file in the first time. The contents are kept, so later changes can be found by comparing with them.
+    // The reader is kept too, since the file is read again after every change that cannot be patched in.
+    char* contents;
+    size_t length;
+    ScheduleData fileData;
+    ScheduleReader* reader;
+    if (!ScheduleReaderCreate(&reader))
+    {
+        close(watchDescriptor);
+        return false;
+    }
+    if (!ReadWholeFile(fileName, &contents, &length))
+    {
+        fprintf(stderr, "Failed to read '%s'.\n", fileName);
+        ScheduleReaderDestroy(&reader);
+        close(watchDescriptor);
+        return false;
+    }
+    if (!ReadScheduleFileFrom(NULL, contents, length, reader, &fileData))
+    {
+        fprintf(stderr, "Failed to read the input schedule file.\n");
+        DestroyScheduleFile(&fileData);
+        free(contents);
+        ScheduleReaderDestroy(&reader);
+        close(watchDescriptor);
+        return false;
+    }
+
+    onChange(&fileData, context);
+    printf("Watching '%s' for changes. Press Ctrl+C to stop.\n", fileName);
+    fflush(stdout);
+
+    while (WaitForChange(watchDescriptor, baseName))
+    {
+        char* newContents;
+        size_t newLength;
+        if (!ReadWholeFile(fileName, &newContents, &newLength))
+        {
+            // The file is missing for the moment. Wait for it to come back.
+            continue;
+        }
+        if (newLength == length && memcmp(newContents, contents, length) == 0)
+        {
+            free(newContents);
+            continue;
+        }
+
+        double startTime = WatchGetMilliseconds();
+
+        // Patch in just the lines that changed if possible, and read the whole file otherwise.
+        const char* howRead = "patched";
+        if (PatchScheduleFile(&fileData, contents, length, newContents, newLength) != ScheduleFilePatched)
+        {
+            howRead = "reparsed";
+            LOG_DEBUG(LogWatch, "The change to '%s' could not be patched in, so it is read again", fileName);
+            ScheduleData newFileData;
+            if (!ReadScheduleFileFrom(NULL, newContents, newLength, reader, &newFileData))
+            {
+                // Keep the last schedule that parsed, along with the contents it was read from, since the patch may
+                // have already changed it.
+                fprintf(stderr, "'%s' has errors. Waiting for the next change.\n", fileName);
+                DestroyScheduleFile(&newFileData);
+                DestroyScheduleFile(&fileData);
+                ReadScheduleFileFrom(NULL, contents, length, reader, &fileData);
+                free(newContents);
+                continue;
+            }
+
+            DestroyScheduleFile(&fileData);
+            fileData = newFileData;
+        }
+
+        free(contents);
+        contents = newContents;
+        length = newLength;
+
+        onChange(&fileData, context);
+        printf("'%s' changed: %s and simulated in %.1f ms.\n", fileName, howRead, WatchGetMilliseconds() - startTime);
+        fflush(stdout);
+    }
+
+    fprintf(stderr, "Stopped watching '%s'.\n", fileName);
+    DestroyScheduleFile(&fileData);
+    free(contents);
+    ScheduleReaderDestroy(&reader);
+    close(watchDescriptor);
+    return false;
+}
@@ -0,0 +1,30 @@
+/**
+ * @file Watch.h
+ */
+
+#pragma once
+
+#include "ScheduleFile.h"
+#include <stdbool.h>
+
+/**
+ * Called with the schedule every time the processes file is read in.
+ * @param fileData The schedule read from the file.
+ * @param context The context that was passed to WatchScheduleFile.
+ */
+typedef void WatchCallback(ScheduleData* fileData, void* context);
+
+/**
+ * @brief Reads a processes file, and reads it again every time it is saved, until the program is interrupted.
+ *
+ * The directory holding the file is watched with inotify, so that editors which save by writing a new file and
+ * renaming it over the old one are noticed as well. When the file changes, only the lines that changed are parsed
+ * again and patched into the schedule, falling back to reading the whole file when the change is more than a change
+ * to "process" lines. A file that fails to parse is reported, and the last schedule that parsed is kept.
+ *
+ * @param fileName The name of the processes file.
+ * @param onChange Called with the schedule once it is first read, and again after every change.
+ * @param context Passed on to onChange.
+ * @return False if the file could not be read or watched. While it can be, this does not return.
+ */
+bool WatchScheduleFile(const char* fileName, WatchCallback* onChange, void* context);
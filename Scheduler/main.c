@@ -2,72 +2,308 @@
 #include "FirstComeFirstServe.h"
 #include "RoundRobin.h"
 #include "SJF.h"
+#include "RealDispatcher.h"
+#include "ResultCache.h"
+#include "CompiledSchedule.h"
+#include "Watch.h"
+#include "Log.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
-void PrintScheduleData(ScheduleData* inputData)
+/**
+ * Logs the schedule that was read in, which is helpful to verify the ScheduleData reader is working properly.
+ */
+void LogScheduleData(ScheduleData* inputData)
 {
-    printf("Process file contents.\n\n");
-    printf("Process Count: %i\n", VectorCount(inputData->processes));
-    printf("Run Time: %i\n", inputData->runLength);
-    printf("Time Quantum: %i\n", inputData->timeQuantum);
+    // Debug messages below the compiled-in log level expand to nothing, so there is nothing to do.
+#if LOG_LEVEL <= LOG_LEVEL_DEBUG
+    // Skip the loop entirely unless the messages are logged.
+    if (!LOG_IS_ENABLED(LOG_LEVEL_DEBUG, LogInput))
+        return;
+
+    static const char* schedulerNames[] = { "First-Come First-Served", "Shortest Job First", "Round-Robin" };
+    LOG_DEBUG(LogInput, "Process Count: %u, Run Time: %u, Time Quantum: %u, Scheduler Type: %s",
+              VectorCount(inputData->processes), inputData->runLength, inputData->timeQuantum,
+              schedulerNames[inputData->schedulerType]);
+
+    for(int i = 0; i < VectorCount(inputData->processes); i++)
+    {
+        InputProcess* process = VectorGet(i, inputData->processes);
+        LOG_DEBUG(LogInput, "Process %i: Name: %s, Arrival Time: %u, Burst Length: %u", i + 1, process->processName,
+                  process->arrivalTime, process->burstLength);
+    }
+#else
+    (void)inputData;
+#endif
+}
+
+void PrintUsage()
+{
+    printf("Usage: Scheduler [processes.in] [options]\n\n");
+    printf("Options:\n");
+    printf("  --real          Run each process's command as a real child process under the scheduling policy.\n");
+    printf("  --tick-ms <ms>  The length of one time unit when running real processes. Defaults to 10.\n");
+    printf("  --parallel      Format and write processes.out on a separate thread while the scheduler runs.\n");
+    printf("  --timeline <n>  Also write a utilization timeline of n time buckets to processes.timeline.\n");
+    printf("  --index <n>     Also write a seek index with an entry every n time units to processes.out.idx.\n");
+    printf("  --watch         Keep running, and simulate again every time processes.in is saved.\n");
+    printf("  --cache <dir>   Keep simulation results in dir, and reuse them when the same schedule is run again.\n");
+    printf("  --cache-limit <MB>  The size the result cache may grow to before old entries are removed. Defaults to 1024.\n");
+    printf("  --compile       Compile processes.in to the binary processes.sched, without running it.\n");
+    printf("  --sched <file>  Run a compiled schedule instead of processes.in.\n");
+    printf("  --sched-cache   Keep processes.sched next to processes.in, and load it while processes.in is unchanged.\n");
+    printf("  --log <list>    Only log the given comma separated categories: main, input, fcfs, sjf, rr, real, cache,\n");
+    printf("                  watch, or all. Which levels are logged is chosen when building, with LOG_LEVEL.\n");
+    printf("  --log-file <f>  Append the log to a file instead of writing it to stderr.\n");
+}
+
+/**
+ * The options given on the command line that decide how a schedule is run.
+ */
+typedef struct tagRunOptions
+{
+    bool runReal;
+    bool parallel;
+    unsigned int timelineBuckets;
+    unsigned int indexStride;
+    unsigned int tickMilliseconds;
+    const char* cacheDirectory;
+    unsigned long long cacheLimitMegabytes;
+} RunOptions;
+
+/**
+ * Runs a schedule with the given options, writing processes.out and any other output files that were asked for.
+ */
+bool RunSchedule(ScheduleData* inputData, const RunOptions* options)
+{
+    // The files a simulation produces, which are what the result cache keeps.
+    const char* outputFiles[3] = { "processes.out" };
+    int outputFileCount = 1;
+    if (options->indexStride > 0)
+        outputFiles[outputFileCount++] = "processes.out.idx";
+    if (options->timelineBuckets > 0)
+        outputFiles[outputFileCount++] = "processes.timeline";
+
+    // Simulations are deterministic, so if the same schedule was simulated before, its output files can be restored
+    // from the cache instead. Real runs are measured, so they are never cached.
+    ResultCacheKey cacheKey;
+    bool useCache = options->cacheDirectory != NULL && !options->runReal;
+    if (useCache)
+    {
+        unsigned int settings[2] = { options->indexStride, options->timelineBuckets };
+        ResultCacheComputeKey(inputData, settings, 2, &cacheKey);
+        if (ResultCacheFetch(options->cacheDirectory, &cacheKey, outputFiles, outputFileCount))
+        {
+            LOG_DEBUG(LogCache, "Restored the results from the cache in '%s'", options->cacheDirectory);
+            return true;
+        }
+        LOG_DEBUG(LogCache, "The results are not in the cache in '%s'", options->cacheDirectory);
+    }
+
+    // Open the trace that the scheduler writes its events and results to.
+    Trace* trace;
+    if (!TraceOpen("processes.out", options->parallel, &trace))
+        return false;
+
+    // Index the trace if asked to, so that TraceQuery can seek straight to a time.
+    if (options->indexStride > 0 && !TraceEnableIndex("processes.out.idx", options->indexStride, trace))
+    {
+        TraceClose(&trace);
+        return false;
+    }
+
+    // Attach a utilization timeline to the trace if one was asked for.
+    Timeline* timeline = NULL;
+    if (options->timelineBuckets > 0)
+    {
+        if (!TimelineCreate(inputData->runLength, options->timelineBuckets, &timeline))
+        {
+            fprintf(stderr, "Failed to create the utilization timeline.\n");
+            TraceClose(&trace);
+            return false;
+        }
+        TraceSetTimeline(timeline, trace);
+    }
+
+    if (options->runReal)
+    {
+        // Run the processes for real instead of simulating them.
+        bool result = RunRealProcesses(inputData, options->tickMilliseconds, trace);
+        TraceClose(&trace);
+        if (timeline != NULL)
+        {
+            result = TimelineWrite("processes.timeline", timeline) && result;
+            TimelineDestroy(&timeline);
+        }
+        return result;
+    }
 
     switch (inputData->schedulerType)
     {
         case FCFS:
-            printf("Scheduler Type: First-Come First-Served\n");
+            // Call First-Come First-Served code.
+            RunFCFSProcess(inputData, trace);
             break;
         case ShortestJob:
-            printf("Scheduler Type: Shortest Job First\n");
+            // Call Shortest Job First code.
+            RunPreemptiveSJFProcess(inputData, trace);
             break;
         case RoundRobin:
-            printf("Scheduler Type: Round-Robin\n");
+            // Call Round-Robin code.
+            RunRRProcess(inputData, trace);
             break;
     }
 
-    for(int i = 0; i < VectorCount(inputData->processes); i++)
+    // Write out the rest of the trace, and the timeline.
+    TraceClose(&trace);
+    if (timeline != NULL)
     {
-        InputProcess* process = VectorGet(i, inputData->processes);
-        printf("Process %i: Name: %s, Arrival Time: %i, Burst Length: %i\n", i + 1, process->processName,
-               process->arrivalTime, process->burstLength);
+        bool written = TimelineWrite("processes.timeline", timeline);
+        TimelineDestroy(&timeline);
+
+        // Without the timeline the results are incomplete, so don't cache them either.
+        if (!written)
+            return false;
     }
+
+    // Keep the results for the next time this schedule is simulated.
+    if (useCache && !ResultCacheStore(options->cacheDirectory, &cacheKey, outputFiles, outputFileCount,
+                                      options->cacheLimitMegabytes * 1024 * 1024))
+        fprintf(stderr, "Failed to store the results in the cache.\n");
+
+    return true;
+}
+
+/**
+ * Runs the schedule again whenever the watched processes file changes.
+ */
+void RunScheduleOnChange(ScheduleData* inputData, void* context)
+{
+    LogScheduleData(inputData);
+    RunSchedule(inputData, context);
+    LogFlush();
 }
 
-int main()
+int main(int argc, char** argv)
 {
-    // Read in the input scheduling data.
-    ScheduleData inputData;
-    bool result = ReadScheduleFile(&inputData);
+    // Parse the command line. The input file is always "processes.in", so a file name argument is accepted but not
+    // needed.
+    RunOptions options = { .tickMilliseconds = 10, .cacheLimitMegabytes = 1024 };
+    bool watch = false;
+    bool compile = false;
+    bool useCompiledCache = false;
+    const char* compiledFileName = NULL;
+    bool result;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--real") == 0)
+        {
+            options.runReal = true;
+        }
+        else if (strcmp(argv[i], "--parallel") == 0)
+        {
+            options.parallel = true;
+        }
+        else if (strcmp(argv[i], "--watch") == 0)
+        {
+            watch = true;
+        }
+        else if (strcmp(argv[i], "--timeline") == 0 && i + 1 < argc)
+        {
+            options.timelineBuckets = (unsigned int)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--index") == 0 && i + 1 < argc)
+        {
+            options.indexStride = (unsigned int)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc)
+        {
+            options.cacheDirectory = argv[++i];
+        }
+        else if (strcmp(argv[i], "--cache-limit") == 0 && i + 1 < argc)
+        {
+            options.cacheLimitMegabytes = strtoull(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--compile") == 0)
+        {
+            compile = true;
+        }
+        else if (strcmp(argv[i], "--sched") == 0 && i + 1 < argc)
+        {
+            compiledFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "--sched-cache") == 0)
+        {
+            useCompiledCache = true;
+        }
+        else if (strcmp(argv[i], "--log") == 0 && i + 1 < argc)
+        {
+            if (!LogSetCategories(argv[++i]))
+                return -1;
+        }
+        else if (strcmp(argv[i], "--log-file") == 0 && i + 1 < argc)
+        {
+            if (!LogOpen(argv[++i]))
+                return -1;
+        }
+        else if (strcmp(argv[i], "--tick-ms") == 0 && i + 1 < argc)
+        {
+            options.tickMilliseconds = (unsigned int)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--help") == 0)
+        {
+            PrintUsage();
+            return 0;
+        }
+        else if (argv[i][0] == '-')
+        {
+            fprintf(stderr, "Unknown option '%s'.\n", argv[i]);
+            PrintUsage();
+            return -1;
+        }
+    }
+
+    // In watch mode, the file is read, and read again after every change, by the watcher.
+    if (watch)
+    {
+        result = WatchScheduleFile("processes.in", RunScheduleOnChange, &options);
+        LogClose();
+        return result ? 0 : -1;
+    }
+
+    // Read in the input scheduling data, from a compiled schedule if there is one to use.
+    ScheduleData inputData = { .processes = NULL };
+    if (compiledFileName != NULL)
+        result = LoadCompiledSchedule(compiledFileName, NULL, &inputData);
+    else if (useCompiledCache)
+        result = ReadScheduleFileCompiled(&inputData);
+    else
+        result = ReadScheduleFile(&inputData);
     if (!result)
     {
         // Failed to read in the input schedule file.
         printf("Failed to read the input schedule file.\n");
+        DestroyScheduleFile(&inputData);
+        LogClose();
         return -1;
     }
 
-    // Set this to 0 to disable this code. This is just nice to have to verify the ScheduleData reader is working
-    // properly.
-#ifdef PRINT_PROCESSES_DATA
-    PrintScheduleData(&inputData);
-#endif
+    LogScheduleData(&inputData);
 
-    switch (inputData.schedulerType)
+    if (compile)
     {
-        case FCFS:
-            // Call First-Come First-Served code.
-            RunFCFSProcess(&inputData);
-            break;
-        case ShortestJob:
-            // Call Shortest Job First code.
-            RunPreemptiveSJFProcess(&inputData);
-            break;
-        case RoundRobin:
-            // Call Round-Robin code.
-            RunRRProcess(&inputData);
-            break;
+        result = CompileSchedule(&inputData, compiledFileName == NULL ? "processes.in" : NULL, "processes.sched");
+        DestroyScheduleFile(&inputData);
+        LogClose();
+        return result ? 0 : -1;
     }
 
+    result = RunSchedule(&inputData, &options);
+
     // Destroy the vector of processes.
-    VectorDestroy(&inputData.processes);
+    DestroyScheduleFile(&inputData);
+    LogClose();
 
-    return 0;
+    return result ? 0 : -1;
 }